@@ -13,11 +13,24 @@ class AbstractFlightGraphNodeContainer {
     Vector<std::shared_ptr<Vector<DateTime>>> datetimes;
     AirportRange airport_range;
 
+    // Open-addressing hash index from (airport, datetime) to the position of
+    // the element in its airport bucket; position -1 marks an empty slot.
+    struct Slot {
+        FlightNodeKey key{0, 0};
+        int position = -1;
+    };
+    Vector<Slot> slots;
+    size_t slot_bits = 4;
+    size_t size = 0;
+    size_t FindSlot(FlightNodeKey key) const;
+    void Rehash(size_t bits);
+
    public:
     AbstractFlightGraphNodeContainer(AirportRange airport_range);
     void Add(Airport airport, DateTime datetime, T element);
     std::optional<T> Get(Airport airport, DateTime datetime) const;
     std::shared_ptr<Vector<T>> Get(Airport airport) const;
+    std::shared_ptr<Vector<DateTime>> GetDateTimes(Airport airport) const;
     void Sort(std::function<bool(T, T)> compare);
 };
 
@@ -31,29 +44,54 @@ inline AbstractFlightGraphNodeContainer<T>::AbstractFlightGraphNodeContainer(Air
         elements[i] = std::make_shared<Vector<T>>();
         datetimes[i] = std::make_shared<Vector<DateTime>>();
     }
+    slots.resize(size_t(1) << slot_bits);
+}
+
+// Returns the slot holding `key`, or the empty slot where it would go.
+template <typename T>
+inline size_t AbstractFlightGraphNodeContainer<T>::FindSlot(FlightNodeKey key) const {
+    auto mask = slots.size() - 1;
+    for (auto i = size_t(FlightNodeKeyHash()(key) >> (64 - slot_bits));; i = (i + 1) & mask)
+        if (slots[i].position < 0 || slots[i].key == key)
+            return i;
+}
+
+template <typename T>
+inline void AbstractFlightGraphNodeContainer<T>::Rehash(size_t bits) {
+    auto rehashed = Vector<Slot>(size_t(1) << bits);
+    slots.swap(rehashed);
+    slot_bits = bits;
+    for (size_t i = 0; i < elements.size(); i++)
+        for (size_t j = 0; j < datetimes[i]->size(); j++) {
+            auto key = FlightNodeKey{Airport(airport_range.min + i), (*datetimes[i])[j]};
+            auto& slot = slots[FindSlot(key)];
+            if (slot.position >= 0)
+                throw std::runtime_error("Non-unique (Airport, DateTime)");
+            slot = {key, int(j)};
+        }
 }
 
 template <typename T>
 inline void AbstractFlightGraphNodeContainer<T>::Add(Airport airport, DateTime datetime, T element) {
     airport_range.WithinOrThrow(airport);
-    elements[airport - airport_range.min]->push_back(element);
+    auto key = FlightNodeKey{airport, datetime};
+    if (slots[FindSlot(key)].position >= 0)
+        throw std::runtime_error("Non-unique (Airport, DateTime)");
+    auto& bucket = *elements[airport - airport_range.min];
+    slots[FindSlot(key)] = {key, int(bucket.size())};
+    bucket.push_back(element);
     datetimes[airport - airport_range.min]->push_back(datetime);
+    // Keep the load factor at most one half.
+    if (++size * 2 > slots.size())
+        Rehash(slot_bits + 1);
 }
 
 template <typename T>
 inline std::optional<T> AbstractFlightGraphNodeContainer<T>::Get(Airport airport, DateTime datetime) const {
     airport_range.WithinOrThrow(airport);
-    auto dt_list = datetimes[airport - airport_range.min];
-    auto size = dt_list->size();
-    auto index = -1;
-    for (auto i = 0; i < size; i++)
-        if ((*dt_list)[i] == datetime) {
-            if (index != -1)
-                throw std::runtime_error("Non-unique (Airport, DateTime)");
-            index = i;
-        }
-    if (index >= 0)
-        return (*elements[airport - airport_range.min])[index];
+    auto& slot = slots[FindSlot({airport, datetime})];
+    if (slot.position >= 0)
+        return (*elements[airport - airport_range.min])[slot.position];
     else
         return std::nullopt;
 }
@@ -64,6 +102,12 @@ inline std::shared_ptr<Vector<T>> AbstractFlightGraphNodeContainer<T>::Get(Airpo
     return elements[airport - airport_range.min];
 }
 
+template <typename T>
+inline std::shared_ptr<Vector<DateTime>> AbstractFlightGraphNodeContainer<T>::GetDateTimes(Airport airport) const {
+    airport_range.WithinOrThrow(airport);
+    return datetimes[airport - airport_range.min];
+}
+
 template <typename T>
 inline void AbstractFlightGraphNodeContainer<T>::Sort(std::function<bool(T, T)> compare) {
     auto total_size = elements.size();
@@ -82,4 +126,6 @@ inline void AbstractFlightGraphNodeContainer<T>::Sort(std::function<bool(T, T)>
             (*elements[i])[j] = (*merged)[j].second;
         }
     }
+    // The positions in the hash index moved with the elements.
+    Rehash(slot_bits);
 }
@@ -25,7 +25,7 @@ class AbstractGraph {
             discrete_children->reserve(edge_keys->size());
             for (auto& edge_key : *edge_keys) {
                 auto child = graph->GetNode(edge_key.node);
-                discrete_children->push_back({child, edge_key.weight});
+                discrete_children->push_back({child.get(), edge_key.weight});
             }
         }
 
@@ -71,8 +71,10 @@ class AbstractGraph {
         if (node_opt)
             return *node_opt;
         auto node = std::shared_ptr<Node>(new Node(static_cast<ConcreteGraph*>(this)->shared_from_this(), key));
-        node->OnDiscovered.AddListener([this, node]() { OnNodeDiscovered.Invoke(node); });
-        node->OnVisited.AddListener([this, node]() { OnNodeVisited.Invoke(node); });
+        // The pool owns the node. Its listeners must not, or the node would own itself.
+        auto handle = node.get();
+        node->OnDiscovered.AddListener([this, handle]() { OnNodeDiscovered.Invoke(handle->shared_from_this()); });
+        node->OnVisited.AddListener([this, handle]() { OnNodeVisited.Invoke(handle->shared_from_this()); });
         AddNodeToPool(key, node);
         return node;
     }
@@ -97,16 +99,9 @@ class AbstractGraph {
     }
 
     std::optional<Path> BestPathTo(PNode from, PNode to) {
-        OnNodeVisited.AddListener([to](auto node) {
-            if (node->IsContinuousChild(to)) {
-                throw node->GetPath();
-            }
-        });
-        try {
-            from->PFS();
-        } catch (Path path) {
-            return path;
-        }
-        return std::nullopt;
+        auto found = from->PFS([to](Node* node) { return node->IsContinuousChild(to); });
+        if (!found)
+            return std::nullopt;
+        return found->GetPath();
     }
 };
@@ -4,6 +4,7 @@
 #include <memory>
 #include <miniSTL/stl.hpp>
 #include <queue>
+#include <vector>
 #include "surakarta_event.hpp"
 
 template <typename ConcreteNode>
@@ -25,8 +26,9 @@ class AbstractNode
     };
 
    protected:
+    // Nodes are owned by their graph; edges and parents only point at them.
     struct Edge {
-        PNode node;
+        Node* node;
         int weight;
     };
 
@@ -37,7 +39,7 @@ class AbstractNode
     Status status = Status::UNDISCOVERED;
     int priority = INT_MAX;
 
-    PNode parent;
+    Node* parent = nullptr;
 
    public:
     Status GetStatus() { return status; }
@@ -60,19 +62,41 @@ class AbstractNode
         auto node = static_cast<Node*>(this);
         while (node != nullptr) {
             path->push_front(node->shared_from_this());
-            node = static_cast<Node*>(node->parent.get());
+            node = node->parent;
         }
         return path;
     }
 
+    // Iterative, in the order of the recursive definition: a node is
+    // discovered when pushed and visited when popped, and its next child is
+    // checked only once the previous one is done.
     void DFS(int depth_limit = INT_MAX) {
-        Discover();
-        auto children = DiscreteChildren();
-        if (depth_limit > 0)
-            for (auto& child : *children)
-                if (child.node->status == Status::UNDISCOVERED)
-                    child.node->DFS(depth_limit - 1);
-        Visit();
+        struct Frame {
+            AbstractNode* node;
+            std::shared_ptr<Vector<Edge>> children;
+            size_t next;
+            int depth_limit;
+        };
+        // Frames hold shared_ptrs, which Vector cannot reuse after pop_back.
+        auto stack = std::vector<Frame>();
+        auto enter = [&stack](AbstractNode* node, int depth_limit) {
+            node->Discover();
+            auto children = depth_limit > 0 ? node->DiscreteChildren() : nullptr;
+            stack.push_back({node, children, 0, depth_limit});
+        };
+        enter(this, depth_limit);
+        while (!stack.empty()) {
+            auto& frame = stack.back();
+            if (frame.children && frame.next < frame.children->size()) {
+                auto child = (*frame.children)[frame.next++].node;
+                if (child->status == Status::UNDISCOVERED)
+                    enter(child, frame.depth_limit - 1);
+            } else {
+                auto node = frame.node;
+                stack.pop_back();
+                node->Visit();
+            }
+        }
     }
 
     void BFS() {
@@ -82,18 +106,22 @@ class AbstractNode
         PFS(update_priority);
     }
 
-    void PFS() {
+    // Ends a search at a visited node it holds for, which the search returns;
+    // it returns nullptr if the search ran to the end.
+    using StopCondition = std::function<bool(Node* node)>;
+
+    Node* PFS(StopCondition stop = nullptr) {
         auto update_priority = [](Node* parent, Node* child, int weight) {
             if (parent->priority + weight < child->priority) {
                 child->priority = parent->priority + weight;
-                child->parent = parent->shared_from_this();
+                child->parent = parent;
             }
         };
-        PFS(update_priority);
+        return PFS(update_priority, stop);
     }
 
     using PriorityUpdater = std::function<void(Node* parent, Node* child, int weight)>;
-    void PFS(PriorityUpdater update_priority) {
+    Node* PFS(PriorityUpdater update_priority, StopCondition stop = nullptr) {
         auto queue = std::priority_queue<Node*, Vector<Node*>, std::function<bool(Node*, Node*)>>(
             [](Node* a, Node* b) { return a->priority > b->priority; });
         priority = 0;
@@ -106,7 +134,7 @@ class AbstractNode
             if (node->status == Status::DISCOVERED) {
                 auto edges = ((AbstractNode*)node)->DiscreteChildren();
                 for (auto& edge : *edges) {
-                    auto new_node = edge.node.get();
+                    auto new_node = edge.node;
                     if (new_node->status == Status::UNDISCOVERED) {
                         update_priority(node, new_node, edge.weight);
                         new_node->Discover();
@@ -114,7 +142,10 @@ class AbstractNode
                     }
                 }
                 node->Visit();
+                if (stop && stop(node))
+                    return node;
             }
         }
+        return nullptr;
     }
 };
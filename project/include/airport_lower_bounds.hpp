@@ -0,0 +1,46 @@
+#pragma once
+#include <climits>
+#include <memory>
+#include <miniSTL/stl.hpp>
+#include <mutex>
+#include <vector>
+#include "flight_database.hpp"
+#include "flight_types.hpp"
+
+// Lower bounds of the cost of reaching a destination airport, for A*.
+//
+// The static airport graph has an edge for every route, weighted by the
+// cheapest fare and the shortest flight time of the route. A reverse
+// Dijkstra from a destination over it gives, for every airport, a total fare
+// and a total time in the air that no journey to the destination can beat.
+// Bounds are computed on first use of a destination and cached.
+class AirportLowerBounds {
+   public:
+    static constexpr int kUnreachable = INT_MAX;
+
+    // Indexed by airport - AirportRange().min.
+    struct Bounds {
+        Vector<int> price;
+        Vector<int> time;
+    };
+
+   private:
+    ::AirportRange airport_range;
+    // The routes into each airport: [offsets[i], offsets[i + 1]) of the other columns.
+    Vector<uint32_t> offsets;
+    Vector<CompactAirport> origins;
+    Vector<int> min_price, min_time;
+
+    mutable std::mutex mutex;
+    mutable std::vector<std::shared_ptr<const Bounds>> cache;
+
+    Vector<int> ReverseDijkstra(Airport destination, const Vector<int>& weights) const;
+
+   public:
+    AirportLowerBounds(const FlightDatabase& flight_database);
+    AirportLowerBounds(const AirportLowerBounds&) = delete;
+    AirportLowerBounds& operator=(const AirportLowerBounds&) = delete;
+
+    ::AirportRange AirportRange() const { return airport_range; }
+    std::shared_ptr<const Bounds> To(Airport destination) const;
+};
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <miniSTL/stl.hpp>
+#include <optional>
+#include <span>
+#include "flight_database.hpp"
+#include "flight_types.hpp"
+#include "radix_heap.hpp"
+#include "search_scratch.hpp"
+
+// One minimum cost query, searched from both ends over the flights of a
+// database.
+//
+// The label of a flight on the forward side is the cheapest price of a
+// journey from the origin that ends with it; on the backward side, of one
+// that starts with it and lands at the destination in time. The forward side
+// starts from the departures of the origin after the earliest departure, the
+// backward side from the arrivals at the destination before the latest
+// arrival, found in the arrival index. A settled flight covers the flights it
+// connects to: on the forward side the departures of its destination no
+// sooner than it lands, a suffix of the departure index; on the backward side
+// the arrivals at its origin no later than it leaves, a prefix of the arrival
+// index. Sides settle in order of price, so the first cover of a flight gives
+// its final label, and every flight is labelled at most once per side.
+//
+// Each label is feasible on its own: the forward side drops flights that land
+// after the latest arrival, the backward side those that leave before the
+// earliest departure. The two sides meet on a flight labelled by both, which
+// joins a journey that lands it and one that starts with it. The search stops
+// when the cheapest labels left on the two sides add up to no less than the
+// best meeting; a cheaper journey would have a flight labelled by both, or two
+// consecutive ones left on the queues whose labels add up to its price.
+class BidirectionalSearch {
+   public:
+    using Journey = std::shared_ptr<List<::Key>>;
+
+    // Flights settled by each side of the last query.
+    struct SearchStats {
+        size_t forward = 0;
+        size_t backward = 0;
+    };
+
+   private:
+    const FlightDatabase& flight_database;
+    std::shared_ptr<SearchScratch> forward, backward;
+    SearchStats stats;
+
+   public:
+    BidirectionalSearch(const FlightDatabase& flight_database);
+    BidirectionalSearch(const BidirectionalSearch&) = delete;
+    BidirectionalSearch& operator=(const BidirectionalSearch&) = delete;
+
+    const SearchStats& Stats() const { return stats; }
+
+    // The flights of the cheapest journey that leaves `airport_from` no sooner
+    // than `datetime_from` and lands at `airport_to` no later than `datetime_to`.
+    std::optional<Journey> MinimumCost(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to);
+};
@@ -0,0 +1,136 @@
+#pragma once
+#include <assert.h>
+#include <algorithm>
+#include <memory>
+#include <miniSTL/stl.hpp>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include "flight_types.hpp"
+
+// Compressed-sparse-row variant of AbstractFlightGraphNodeContainer for
+// buckets that are built once. The elements of every airport are stored
+// contiguously, sorted by (airport, datetime); the i-th airport owns
+// [offsets[i], offsets[i + 1]) of the element and datetime arrays.
+template <typename T>
+class CompactFlightGraphNodeContainer {
+   private:
+    struct Storage {
+        Vector<uint32_t> offsets;
+        Vector<T> elements;
+        Vector<DateTime> datetimes;
+    };
+
+    AirportRange airport_range;
+    std::span<const uint32_t> offsets;
+    std::span<const T> elements;
+    std::span<const DateTime> datetimes;
+    std::shared_ptr<Storage> storage;
+
+   public:
+    CompactFlightGraphNodeContainer() = default;
+    // Buckets `source` by airport in one counting-sort pass, then orders every
+    // bucket by `compare`, which must order by datetime first.
+    template <typename AirportOf, typename DateTimeOf, typename Compare>
+    CompactFlightGraphNodeContainer(AirportRange airport_range, std::span<const T> source,
+                                    AirportOf airport_of, DateTimeOf datetime_of, Compare compare);
+    // Views arrays that live elsewhere, such as the sections of a mapped snapshot.
+    CompactFlightGraphNodeContainer(AirportRange airport_range, std::span<const uint32_t> offsets,
+                                    std::span<const T> elements, std::span<const DateTime> datetimes);
+    std::optional<T> Get(Airport airport, DateTime datetime) const;
+    std::span<const T> Get(Airport airport) const;
+    std::span<const T> Get(Airport airport, DateTime not_before, DateTime not_after) const;
+    std::span<const DateTime> GetDateTimes(Airport airport) const;
+    std::span<const uint32_t> Offsets() const { return offsets; }
+    std::span<const T> Elements() const { return elements; }
+    std::span<const DateTime> DateTimes() const { return datetimes; }
+};
+
+template <typename T>
+template <typename AirportOf, typename DateTimeOf, typename Compare>
+inline CompactFlightGraphNodeContainer<T>::CompactFlightGraphNodeContainer(
+    AirportRange airport_range, std::span<const T> source, AirportOf airport_of, DateTimeOf datetime_of, Compare compare)
+    : airport_range(airport_range), storage(std::make_shared<Storage>()) {
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    storage->offsets.resize(airports + 1);
+    for (auto& offset : storage->offsets)
+        offset = 0;
+    for (auto& element : source) {
+        auto airport = airport_of(element);
+        airport_range.WithinOrThrow(airport);
+        storage->offsets[airport - airport_range.min + 1]++;
+    }
+    for (size_t i = 0; i < airports; i++)
+        storage->offsets[i + 1] += storage->offsets[i];
+
+    auto cursor = Vector<uint32_t>();
+    cursor.reserve(airports);
+    for (size_t i = 0; i < airports; i++)
+        cursor.push_back(storage->offsets[i]);
+    storage->elements.resize(source.size());
+    for (auto& element : source)
+        storage->elements[cursor[airport_of(element) - airport_range.min]++] = element;
+
+    storage->datetimes.resize(source.size());
+    for (size_t i = 0; i < airports; i++) {
+        auto begin = storage->elements.begin() + storage->offsets[i];
+        auto end = storage->elements.begin() + storage->offsets[i + 1];
+        std::sort(begin, end, compare);
+        for (auto j = storage->offsets[i]; j < storage->offsets[i + 1]; j++)
+            storage->datetimes[j] = datetime_of(storage->elements[j]);
+        assert(std::is_sorted(storage->datetimes.begin() + storage->offsets[i],
+                              storage->datetimes.begin() + storage->offsets[i + 1]));
+    }
+
+    offsets = {storage->offsets.data(), storage->offsets.size()};
+    elements = {storage->elements.data(), storage->elements.size()};
+    datetimes = {storage->datetimes.data(), storage->datetimes.size()};
+}
+
+template <typename T>
+inline CompactFlightGraphNodeContainer<T>::CompactFlightGraphNodeContainer(
+    AirportRange airport_range, std::span<const uint32_t> offsets,
+    std::span<const T> elements, std::span<const DateTime> datetimes)
+    : airport_range(airport_range), offsets(offsets), elements(elements), datetimes(datetimes) {
+    if (offsets.size() != size_t(airport_range.max - airport_range.min) + 2 ||
+        elements.size() != datetimes.size() || offsets.front() != 0 || offsets.back() != elements.size())
+        throw std::runtime_error("Malformed airport bucket index");
+    for (size_t i = 1; i < offsets.size(); i++)
+        if (offsets[i - 1] > offsets[i])
+            throw std::runtime_error("Malformed airport bucket index");
+}
+
+template <typename T>
+inline std::optional<T> CompactFlightGraphNodeContainer<T>::Get(Airport airport, DateTime datetime) const {
+    auto found = Get(airport, datetime, datetime);
+    if (found.size() > 1)
+        throw std::runtime_error("Non-unique (Airport, DateTime)");
+    if (found.empty())
+        return std::nullopt;
+    return found[0];
+}
+
+template <typename T>
+inline std::span<const T> CompactFlightGraphNodeContainer<T>::Get(Airport airport) const {
+    airport_range.WithinOrThrow(airport);
+    auto index = airport - airport_range.min;
+    return elements.subspan(offsets[index], offsets[index + 1] - offsets[index]);
+}
+
+template <typename T>
+inline std::span<const T>
+CompactFlightGraphNodeContainer<T>::Get(Airport airport, DateTime not_before, DateTime not_after) const {
+    auto bucket = GetDateTimes(airport);
+    if (not_before > not_after)
+        return {};
+    auto begin = std::lower_bound(bucket.begin(), bucket.end(), not_before);
+    auto end = std::upper_bound(begin, bucket.end(), not_after);
+    return elements.subspan(begin - datetimes.begin(), end - begin);
+}
+
+template <typename T>
+inline std::span<const DateTime> CompactFlightGraphNodeContainer<T>::GetDateTimes(Airport airport) const {
+    airport_range.WithinOrThrow(airport);
+    auto index = airport - airport_range.min;
+    return datetimes.subspan(offsets[index], offsets[index + 1] - offsets[index]);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#include <memory>
+#include <miniSTL/stl.hpp>
+#include <optional>
+#include <span>
+#include "airport_lower_bounds.hpp"
+#include "flight_database.hpp"
+#include "flight_types.hpp"
+
+// Connection Scan Algorithm over every flight of a database, built once and
+// shared by every query.
+//
+// The flights are one array of connections sorted by departure time. An
+// earliest-arrival query scans it from the start time, keeping the earliest
+// arrival at every airport and the connection that achieved it; it needs no
+// graph and no queue, and reads the array front to back.
+class ConnectionScan {
+   public:
+    struct Connection {
+        DateTime departure, arrival;
+        CompactAirport from, to;
+        ::Key id;
+    };
+    using Journey = std::shared_ptr<List<::Key>>;
+    // Leave the origin at `departure` and land at the destination at `arrival`.
+    struct ProfileEntry {
+        DateTime departure, arrival;
+    };
+    using Profile = std::shared_ptr<Vector<ProfileEntry>>;
+    using JourneyList = std::shared_ptr<List<Journey>>;
+
+   private:
+    ::AirportRange airport_range;
+    Vector<Connection> connections;
+    // The price of each connection, kept apart so an earliest-arrival scan
+    // reads only what it needs.
+    Vector<Price> prices;
+
+   public:
+    ConnectionScan(const FlightDatabase& flight_database);
+    ConnectionScan(const ConnectionScan&) = delete;
+    ConnectionScan& operator=(const ConnectionScan&) = delete;
+
+    std::span<const Connection> Connections() const { return {connections.data(), connections.size()}; }
+
+    // The flights of a journey that leaves `airport_from` no sooner than
+    // `datetime_from` and lands at `airport_to` as early as possible, but no
+    // later than `datetime_to`. The scan ends at the first connection that
+    // departs after either bound.
+    std::optional<Journey> EarliestArrival(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to) const;
+    // Every journey from `airport_from` to `airport_to` that leaves no sooner
+    // than `datetime_from` and lands no later than `datetime_to`, kept only if
+    // no other one leaves later and lands sooner, in order of departure. The
+    // earliest arrival from any time in the window is the first entry that
+    // leaves no sooner. One reverse scan over the connections of the window.
+    Profile ArrivalProfile(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to) const;
+    // Every journey within the same bounds that no other one beats on arrival,
+    // total price and number of legs at once, by arrival, then price. One scan
+    // keeps a bag of labels at every airport, each the arrival, price and legs
+    // of a journey that has landed there; a label that lands is dropped if the
+    // bag has one as cheap with as few legs, which landed no later, and drops
+    // those it beats the same way. A bag holds a label per number of legs at
+    // most, and every label of the origin's bag extends over each departure.
+    // With `bounds` to the destination, a label is dropped as soon as it
+    // cannot land in time, or the destination's bag beats it plus its bounds.
+    JourneyList ParetoJourneys(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to,
+                               const AirportLowerBounds::Bounds* bounds = nullptr) const;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include <string>
+
+// Splits CSV lines into fields. The delimiters of a line are located a 64-byte
+// block at a time with SSE2 or AVX2 when the CPU has them; the best kind is
+// picked through CPUID on first use and can be overridden with Select().
+class CsvScanner {
+   public:
+    enum class Kind {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    static Kind Detect();
+    static Kind Active();
+    static bool Supported(Kind kind);
+    // Not thread-safe; meant for start-up configuration and benchmarks.
+    static void Select(Kind kind);
+    static std::string Name(Kind kind);
+
+    // Finds the delimiters of the line starting at `begin`: delimiters[i] is the
+    // ',' that ends field i, and the '\n' (or `end`) ends the last field. Returns
+    // the number of fields, at most `max_fields`; commas beyond that stay inside
+    // the last field.
+    static int SplitLine(const char* begin, const char* end, const char** delimiters, int max_fields);
+};
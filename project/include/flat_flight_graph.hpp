@@ -0,0 +1,283 @@
+#pragma once
+#include <assert.h>
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <miniSTL/stl.hpp>
+#include <optional>
+#include <queue>
+#include "airport_lower_bounds.hpp"
+#include "flight_types.hpp"
+#include "indexed_heap.hpp"
+#include "radix_heap.hpp"
+#include "search_scratch.hpp"
+#include "surakarta_event.hpp"
+#include "time_expanded_flight_graph.hpp"
+
+// One search over a shared TimeExpandedFlightGraph.
+//
+// Nodes are named by the dense ids of the graph. A key that is not an arrival
+// event, such as the start of a query, gets a query-local id past the end of
+// the graph. The search state lives in a pooled SearchScratch, so a query
+// allocates nothing in the steady state.
+class FlatFlightGraph {
+   public:
+    using NodeId = TimeExpandedFlightGraph::NodeId;
+    static constexpr NodeId kNoNode = TimeExpandedFlightGraph::kNoNode;
+
+    enum class Weight {
+        NONE,
+        TIME,
+        PRICE
+    };
+    using Status = SearchScratch::Status;
+
+    using Path = std::shared_ptr<List<NodeId>>;
+    using PathList = std::shared_ptr<List<Path>>;
+
+    // Priority queues Dijkstra can run on.
+    enum class Queue {
+        BINARY_HEAP,
+        QUATERNARY_HEAP,
+        RADIX_HEAP
+    };
+
+    // Queue work of the last Dijkstra search; on a RadixHeap a decrease-key
+    // adds a second entry for the node. Every pop settles a node.
+    struct SearchStats {
+        size_t pushes = 0;
+        size_t pops = 0;
+        size_t decrease_keys = 0;
+    };
+
+    // What a visitor hook asks of the traversal that called it.
+    enum class Control {
+        CONTINUE,
+        STOP
+    };
+
+    // Hooks of the templated traversals, resolved at compile time. A visitor
+    // derives from this and hides the hooks it needs; returning STOP ends the
+    // traversal on the spot, leaving the rest of the nodes as they are.
+    struct Visitor {
+        Control Discover(NodeId) { return Control::CONTINUE; }
+        Control Visit(NodeId) { return Control::CONTINUE; }
+    };
+
+   private:
+    std::shared_ptr<const TimeExpandedFlightGraph> graph;
+    Weight weight;
+
+    std::shared_ptr<SearchScratch> scratch;
+    Vector<FlightNodeKey> local_keys;
+    SearchStats stats;
+    // Room kept in the scratch for query-local nodes.
+    static constexpr size_t kLocalNodes = 16;
+
+    TimeExpandedFlightGraph::EdgeRange EdgesOf(NodeId node) const;
+    int EdgeWeight(NodeId from, TimeExpandedFlightGraph::EdgeId edge) const;
+    template <typename SearchVisitor, typename UpdatePriority>
+    Control PFS(NodeId source, SearchVisitor& visitor, UpdatePriority update_priority);
+
+    // Fires OnNodeDiscovered and OnNodeVisited, for the untemplated traversals.
+    struct EventVisitor : Visitor {
+        FlatFlightGraph& search;
+        EventVisitor(FlatFlightGraph& search) : search(search) {}
+        Control Discover(NodeId node) {
+            search.OnNodeDiscovered.Invoke(node);
+            return Control::CONTINUE;
+        }
+        Control Visit(NodeId node) {
+            search.OnNodeVisited.Invoke(node);
+            return Control::CONTINUE;
+        }
+    };
+
+   public:
+    FlatFlightGraph(std::shared_ptr<const TimeExpandedFlightGraph> graph, Weight weight = Weight::NONE);
+    FlatFlightGraph(const FlatFlightGraph&) = delete;
+    FlatFlightGraph& operator=(const FlatFlightGraph&) = delete;
+
+    mutable SurakartaEvent<NodeId> OnNodeDiscovered;
+    mutable SurakartaEvent<NodeId> OnNodeVisited;
+
+    const TimeExpandedFlightGraph& Graph() const { return *graph; }
+    NodeId GetNode(FlightNodeKey key);
+    FlightNodeKey Key(NodeId node) const;
+    size_t NodeCount() const { return graph->NodeCount() + local_keys.size(); }
+    // The child `parent` is reached from without taking a flight.
+    bool IsContinuousChild(NodeId parent, NodeId child) const;
+
+    Status GetStatus(NodeId node) const { return scratch->GetStatus(node); }
+    void Discover(NodeId node, bool emit_event = true);
+    void Visit(NodeId node, bool emit_event = true);
+    Path GetPath(NodeId node) const;
+    const SearchStats& Stats() const { return stats; }
+
+    void DFS(NodeId node, int depth_limit = INT_MAX);
+    void BFS(NodeId node);
+    void PFS(NodeId node);
+    // These return STOP if the visitor stopped them.
+    template <typename SearchVisitor>
+    Control DFS(NodeId node, SearchVisitor& visitor, int depth_limit = INT_MAX);
+    template <typename SearchVisitor>
+    Control BFS(NodeId node, SearchVisitor& visitor);
+    template <typename SearchVisitor>
+    Control PFS(NodeId node, SearchVisitor& visitor);
+    // A lower bound of the weight from a node to the goal, or kPruned for a
+    // node that cannot reach it. It must be consistent: no edge may lower the
+    // bound by more than its weight.
+    static constexpr int kPruned = INT_MAX;
+    struct NoHeuristic {
+        int operator()(NodeId) const { return 0; }
+    };
+
+    // Label-setting: unlike PFS, a node found again through a cheaper edge is
+    // relaxed, so nodes are visited in the order of their optimal priority.
+    // With a heuristic this is A*: the priority of a node is its weight from
+    // the source plus its bound. PriorityQueue is IndexedHeap<Arity> or RadixHeap.
+    template <typename PriorityQueue = IndexedHeap<4>, typename SearchVisitor, typename Heuristic = NoHeuristic>
+    Control Dijkstra(NodeId node, SearchVisitor& visitor, Heuristic heuristic = {});
+
+    PathList AllPathsTo(NodeId from, NodeId to, int depth_limit);
+    // The path PFS stops on, as the node graph finds it.
+    std::optional<Path> BestPathTo(NodeId from, NodeId to);
+    // An optimal path by the weight of the search, found with Dijkstra.
+    std::optional<Path> ShortestPathTo(NodeId from, NodeId to, Queue queue = Queue::RADIX_HEAP);
+    // The same with A*, guided by bounds to the airport of `to`. Nodes that
+    // cannot land there by its time even in the air without a wait are pruned.
+    std::optional<Path> ShortestPathTo(NodeId from, NodeId to, const AirportLowerBounds::Bounds& bounds);
+};
+
+// Iterative, so the depth of a chain of flights is not bounded by the call
+// stack. A node is discovered when pushed and visited when popped, and each
+// edge is tried only once the previous child is done, exactly as a recursive
+// DFS would.
+template <typename SearchVisitor>
+inline FlatFlightGraph::Control FlatFlightGraph::DFS(NodeId node, SearchVisitor& visitor, int depth_limit) {
+    auto& stack = scratch->Stack();
+    auto base = stack.size();
+    auto target = graph->EdgeTargetColumn();
+    auto enter = [&](NodeId node, int depth_limit) {
+        scratch->SetStatus(node, Status::DISCOVERED);
+        auto edges = depth_limit > 0 ? EdgesOf(node) : TimeExpandedFlightGraph::EdgeRange{0, 0};
+        stack.push_back({node, edges.begin, edges.end, depth_limit});
+        return visitor.Discover(node);
+    };
+    auto control = enter(node, depth_limit);
+    while (stack.size() > base && control == Control::CONTINUE) {
+        auto& frame = stack.back();
+        if (frame.next_edge < frame.end_edge) {
+            auto child = target[frame.next_edge++];
+            if (scratch->GetStatus(child) == Status::UNDISCOVERED)
+                control = enter(child, frame.depth_limit - 1);
+        } else {
+            auto node = frame.node;
+            stack.pop_back();
+            scratch->SetStatus(node, Status::VISITED);
+            control = visitor.Visit(node);
+        }
+    }
+    while (stack.size() > base)
+        stack.pop_back();
+    return control;
+}
+
+template <typename SearchVisitor>
+inline FlatFlightGraph::Control FlatFlightGraph::BFS(NodeId node, SearchVisitor& visitor) {
+    return PFS(node, visitor, [this](NodeId parent, NodeId child, int) {
+        scratch->SetPriority(child, scratch->GetPriority(parent) + 1);
+    });
+}
+
+template <typename SearchVisitor>
+inline FlatFlightGraph::Control FlatFlightGraph::PFS(NodeId node, SearchVisitor& visitor) {
+    return PFS(node, visitor, [this](NodeId parent, NodeId child, int weight) {
+        if (scratch->GetPriority(parent) + weight < scratch->GetPriority(child)) {
+            scratch->SetPriority(child, scratch->GetPriority(parent) + weight);
+            scratch->SetParent(child, parent);
+        }
+    });
+}
+
+// Breaks ties exactly like AbstractNode::PFS, which compares priorities only.
+template <typename SearchVisitor, typename UpdatePriority>
+inline FlatFlightGraph::Control FlatFlightGraph::PFS(NodeId source, SearchVisitor& visitor, UpdatePriority update_priority) {
+    auto compare = [this](NodeId a, NodeId b) { return scratch->GetPriority(a) > scratch->GetPriority(b); };
+    auto queue = std::priority_queue<NodeId, Vector<NodeId>, decltype(compare)>(compare);
+    scratch->SetPriority(source, 0);
+    scratch->SetStatus(source, Status::DISCOVERED);
+    if (visitor.Discover(source) == Control::STOP)
+        return Control::STOP;
+    queue.push(source);
+    while (!queue.empty()) {
+        auto node = queue.top();
+        queue.pop();
+        assert(scratch->GetStatus(node) != Status::UNDISCOVERED);
+        if (scratch->GetStatus(node) == Status::DISCOVERED) {
+            auto edges = EdgesOf(node);
+            auto target = graph->EdgeTargetColumn();
+            for (auto edge = edges.begin; edge < edges.end; edge++) {
+                auto child = target[edge];
+                if (scratch->GetStatus(child) == Status::UNDISCOVERED) {
+                    update_priority(node, child, EdgeWeight(node, edge));
+                    scratch->SetStatus(child, Status::DISCOVERED);
+                    if (visitor.Discover(child) == Control::STOP)
+                        return Control::STOP;
+                    queue.push(child);
+                }
+            }
+            scratch->SetStatus(node, Status::VISITED);
+            if (visitor.Visit(node) == Control::STOP)
+                return Control::STOP;
+        }
+    }
+    return Control::CONTINUE;
+}
+
+template <typename PriorityQueue, typename SearchVisitor, typename Heuristic>
+inline FlatFlightGraph::Control FlatFlightGraph::Dijkstra(NodeId source, SearchVisitor& visitor, Heuristic heuristic) {
+    auto queue = PriorityQueue(*scratch);
+    auto target = graph->EdgeTargetColumn();
+    stats = {};
+    auto bound = heuristic(source);
+    if (bound == kPruned)
+        return Control::CONTINUE;
+    scratch->SetPriority(source, bound);
+    scratch->SetStatus(source, Status::DISCOVERED);
+    if (visitor.Discover(source) == Control::STOP)
+        return Control::STOP;
+    queue.Push(source), stats.pushes++;
+    while (!queue.Empty()) {
+        auto node = queue.Pop();
+        stats.pops++;
+        scratch->SetStatus(node, Status::VISITED);
+        if (visitor.Visit(node) == Control::STOP)
+            return Control::STOP;
+        auto weight = scratch->GetPriority(node) - heuristic(node);
+        auto edges = EdgesOf(node);
+        for (auto edge = edges.begin; edge < edges.end; edge++) {
+            auto child = target[edge];
+            auto status = scratch->GetStatus(child);
+            if (status == Status::VISITED)
+                continue;
+            auto bound = heuristic(child);
+            if (bound == kPruned)
+                continue;
+            auto priority = weight + EdgeWeight(node, edge) + bound;
+            if (priority >= scratch->GetPriority(child))
+                continue;
+            scratch->SetPriority(child, priority);
+            scratch->SetParent(child, node);
+            if (status == Status::DISCOVERED) {
+                queue.DecreaseKey(child), stats.decrease_keys++;
+                continue;
+            }
+            scratch->SetStatus(child, Status::DISCOVERED);
+            if (visitor.Discover(child) == Control::STOP)
+                return Control::STOP;
+            queue.Push(child), stats.pushes++;
+        }
+    }
+    return Control::CONTINUE;
+}
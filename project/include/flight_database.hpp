@@ -2,35 +2,136 @@
 #include <memory>
 #include <miniSTL/stl.hpp>
 #include <optional>
+#include <span>
 #include <string>
-#include "abstract_flight_graph_node_container.hpp"
+#include <string_view>
+#include "compact_flight_graph_node_container.hpp"
 #include "flight_types.hpp"
+#include "mapped_file.hpp"
 
 class FlightDatabase {
    public:
-    FlightDatabase(std::string filename);
+    enum class LoadMode {
+        STREAM,  // std::getline per line, std::string per field
+        MAPPED,  // mmap the file and parse fields in place
+        SNAPSHOT  // mmap a snapshot written by SaveSnapshot and query it in place
+    };
+
+    // `threads` > 1 splits a MAPPED load into that many chunks parsed concurrently.
+    FlightDatabase(std::string filename, LoadMode mode = LoadMode::MAPPED, int threads = 1);
+    FlightDatabase(const FlightDatabase&) = delete;
+    FlightDatabase& operator=(const FlightDatabase&) = delete;
     struct Record {
         Key id;
         Airport airport_from, airport_to;
         DateTime datetime_from, datetime_to;
         Price price;
+        FlightNumber flight_number;
     };
 
     DateTime ParseDateTime(std::string datetime);
+    // Parses CSV rows (without the header line) and appends them to `output`.
+    // Returns false if parsing stopped at an empty line, which ends the table.
+    static bool ParseRecords(std::string_view text, Vector<Record>& output);
     Record QueryRecordById(Key id) const;
     Record QueryRecordByAirportsAndArrivalTime(Airport airport_from, Airport airport_to, DateTime datetime_to) const;
-    std::shared_ptr<Vector<Key>> QueryRecordIdsByAirportFrom(Airport airport) const;
-    std::shared_ptr<Vector<Key>> QueryRecordIdsByAirportTo(Airport airport) const;
+    std::span<const Key> QueryRecordIdsByAirportFrom(Airport airport) const;
+    std::span<const Key> QueryRecordIdsByAirportTo(Airport airport) const;
+    // Departures (arrivals) of `airport` whose departure (arrival) time lies in
+    // [not_before, not_after], found by binary search in the sorted bucket.
+    std::span<const Key> QueryRecordIdsByAirportFrom(Airport airport, DateTime not_before, DateTime not_after) const;
+    std::span<const Key> QueryRecordIdsByAirportTo(Airport airport, DateTime not_before, DateTime not_after) const;
+    // Flights from `airport_from` to `airport_to` ordered by departure time,
+    // optionally only those departing in [not_before, not_after].
+    std::span<const Key> QueryRecordIdsByRoute(Airport airport_from, Airport airport_to) const;
+    std::span<const Key> QueryRecordIdsByRoute(Airport airport_from, Airport airport_to, DateTime not_before, DateTime not_after) const;
+    // The airports with a direct flight from `airport_from`, in ascending order.
+    std::span<const CompactAirport> QueryRouteDestinations(Airport airport_from) const;
+    // The same flights ordered by arrival time, only those arriving in [not_before, not_after].
+    std::span<const Key> QueryRecordIdsByRouteArrival(Airport airport_from, Airport airport_to, DateTime not_before, DateTime not_after) const;
     ::AirportRange AirportRange() const { return airport_range; }
+    size_t RecordCount() const { return columns.price.size(); }
+
+    // Column views of the flight table; element i belongs to Flight ID i + 1.
+    std::span<const CompactAirport> AirportFromColumn() const { return columns.airport_from; }
+    std::span<const CompactAirport> AirportToColumn() const { return columns.airport_to; }
+    std::span<const DateTime> DateTimeFromColumn() const { return columns.datetime_from; }
+    std::span<const DateTime> DateTimeToColumn() const { return columns.datetime_to; }
+    std::span<const Price> PriceColumn() const { return columns.price; }
+    std::span<const FlightNumber> FlightNumberColumn() const { return columns.flight_number; }
+    static constexpr size_t kBytesPerRecord =
+        2 * sizeof(CompactAirport) + 2 * sizeof(DateTime) + sizeof(Price) + sizeof(FlightNumber);
+
+    // Writes the flight table and all indexes to a .fdb snapshot.
+    void SaveSnapshot(std::string filename) const;
+    // Throws if the checksum of a snapshot does not match its contents.
+    // Loading a snapshot does not check it, to keep start-up O(1).
+    static void VerifySnapshot(std::string filename);
 
    private:
+    // Rows parsed from CSV; emptied once they are stored as columns.
     Vector<Record> records;
+
+    // The flight table, one array per field. The arrays are owned by
+    // `column_storage` or live in the mapped snapshot.
+    struct Columns {
+        std::span<const CompactAirport> airport_from, airport_to;
+        std::span<const DateTime> datetime_from, datetime_to;
+        std::span<const Price> price;
+        std::span<const FlightNumber> flight_number;
+    } columns;
+    struct ColumnStorage {
+        Vector<CompactAirport> airport_from, airport_to;
+        Vector<DateTime> datetime_from, datetime_to;
+        Vector<Price> price;
+        Vector<FlightNumber> flight_number;
+    };
+    std::shared_ptr<ColumnStorage> column_storage;
+    void InitColumns();
     Record ParseRecord(std::string line);
+    static constexpr int kFieldCount = 11;
+    static Record ParseRecordInPlace(const char* line, const char* const* delimiters, int fields);
     void LoadDatabase(std::string filename);
+    void LoadDatabaseMapped(std::string filename, int threads);
+    void LoadChunksInParallel(std::string_view text, int threads);
 
     ::AirportRange airport_range;
     void InitAirportRange();
 
-    std::shared_ptr<AbstractFlightGraphNodeContainer<Key>> airport_from_bucket_index, airport_to_bucket_index;
+    // Record ids by departure airport and time, and by arrival airport and time.
+    CompactFlightGraphNodeContainer<Key> airport_from_bucket_index, airport_to_bucket_index;
     void InitAirportBucketIndex();
+
+    // The ids of one route and the time each one is sorted by.
+    struct Bucket {
+        std::span<const Key> ids;
+        std::span<const DateTime> datetimes;
+        std::span<const Key> Slice(DateTime not_before, DateTime not_after) const;
+    };
+    // Flights grouped by (airport_from, airport_to). The routes leaving the
+    // i-th airport are [origins[i], origins[i + 1]), sorted by destination, and
+    // the flights of route r are [offsets[r], offsets[r + 1]) in both orders.
+    struct RouteIndex {
+        std::span<const uint32_t> origins;
+        std::span<const CompactAirport> destinations;
+        std::span<const uint32_t> offsets;
+        std::span<const Key> ids_by_departure, ids_by_arrival;
+        std::span<const DateTime> departures, arrivals;
+    } route_index;
+    struct RouteIndexStorage {
+        Vector<uint32_t> origins;
+        Vector<CompactAirport> destinations;
+        Vector<uint32_t> offsets;
+        Vector<Key> ids_by_departure, ids_by_arrival;
+        Vector<DateTime> departures, arrivals;
+    };
+    std::shared_ptr<RouteIndexStorage> route_index_storage;
+    void InitRouteIndex();
+    // Returns the route number of (airport_from, airport_to), or -1 if no flight serves it.
+    long FindRoute(Airport airport_from, Airport airport_to) const;
+    Bucket RouteDepartures(Airport airport_from, Airport airport_to) const;
+    Bucket RouteArrivals(Airport airport_from, Airport airport_to) const;
+
+    std::shared_ptr<MappedFile> snapshot;
+    void LoadSnapshot(std::string filename);
 };
@@ -3,7 +3,7 @@
 #include "flight_database.hpp"
 
 class FlightGraphComplete : public AbstractFlightGraph {
-   private:
+   protected:
     std::shared_ptr<FlightDatabase> flight_database;
 
    public:
@@ -11,18 +11,19 @@ class FlightGraphComplete : public AbstractFlightGraph {
         : AbstractFlightGraph(flight_database->AirportRange()), flight_database(flight_database) {}
 
    protected:
-    virtual int Weight(FlightNodeKey from, FlightDatabase::Record& record) const { return 0; }
+    // `index` is the row of the flight in the database columns (Flight ID - 1).
+    virtual int Weight(FlightNodeKey, size_t) const { return 0; }
     virtual std::shared_ptr<Vector<EdgeKey>> DiscreteChildrenOf(FlightNodeKey node) const override {
         auto airport = node.airport;
         auto no_sooner_than = node.no_sooner_than;
-        auto record_ids = flight_database->QueryRecordIdsByAirportFrom(airport);
+        auto record_ids = flight_database->QueryRecordIdsByAirportFrom(airport, no_sooner_than, kDateTimeMax);
         auto edge_keys = std::make_shared<Vector<EdgeKey>>();
-        edge_keys->reserve(record_ids->size());
-        for (auto record_id : *record_ids) {
-            auto record = flight_database->QueryRecordById(record_id);
-            if (record.datetime_from < no_sooner_than)
-                continue;
-            edge_keys->push_back({{record.airport_to, record.datetime_to}, Weight(node, record)});
+        edge_keys->reserve(record_ids.size());
+        auto airport_to = flight_database->AirportToColumn();
+        auto datetime_to = flight_database->DateTimeToColumn();
+        for (auto record_id : record_ids) {
+            auto index = record_id - 1;
+            edge_keys->push_back({{airport_to[index], datetime_to[index]}, Weight(node, index)});
         }
         return edge_keys;
     }
@@ -7,7 +7,7 @@ class FlightGraphCompleteWithPrice : public FlightGraphComplete {
         : FlightGraphComplete(flight_database) {};
 
    protected:
-    virtual int Weight(FlightNodeKey from, FlightDatabase::Record& record) const override {
-        return record.price;
+    virtual int Weight(FlightNodeKey, size_t index) const override {
+        return flight_database->PriceColumn()[index];
     }
 };
@@ -7,7 +7,7 @@ class FlightGraphCompleteWithTime : public FlightGraphComplete {
         : FlightGraphComplete(flight_database) {};
 
    protected:
-    virtual int Weight(FlightNodeKey from, FlightDatabase::Record& record) const override {
-        return record.datetime_to - from.no_sooner_than;
+    virtual int Weight(FlightNodeKey from, size_t index) const override {
+        return flight_database->DateTimeToColumn()[index] - from.no_sooner_than;
     }
 };
@@ -1,16 +1,36 @@
 #pragma once
-#include "abstract_flight_graph.hpp"
+#include <mutex>
+#include "connection_scan.hpp"
+#include "flat_flight_graph.hpp"
 #include "flight_database.hpp"
+#include "raptor.hpp"
 
 class Planner {
    private:
     std::shared_ptr<FlightDatabase> db;
+    // Built once from `db` and shared by every query.
+    std::shared_ptr<const TimeExpandedFlightGraph> graph;
+    // Flights by departure time, for earliest-arrival queries.
+    std::shared_ptr<const ConnectionScan> connections;
+    // Per-destination bounds that guide minimum cost queries (A*).
+    std::shared_ptr<const AirportLowerBounds> bounds;
+    // Trips grouped into routes, for queries by number of rides. Built on
+    // the first of them, as most planners never make one.
+    mutable std::once_flag raptor_built;
+    mutable std::shared_ptr<const Raptor> raptor;
 
    public:
     Planner(std::shared_ptr<FlightDatabase> db)
-        : db(db) {}
+        : db(db),
+          graph(std::make_shared<TimeExpandedFlightGraph>(*db)),
+          connections(std::make_shared<ConnectionScan>(*db)),
+          bounds(std::make_shared<AirportLowerBounds>(*db)) {}
+
+    std::shared_ptr<const TimeExpandedFlightGraph> Graph() const { return graph; }
+    std::shared_ptr<const ConnectionScan> Connections() const { return connections; }
+    std::shared_ptr<const AirportLowerBounds> Bounds() const { return bounds; }
+    std::shared_ptr<const Raptor> Trips() const;
 
-    using PNode = std::shared_ptr<AbstractFlightGraph::Node>;
     using Path = std::shared_ptr<Vector<FlightDatabase::Record>>;
     using PathList = std::shared_ptr<List<Path>>;
 
@@ -19,21 +39,46 @@ class Planner {
     PathList EnumerateAllPaths(
         int airport_from,
         int airport_to,
-        DateTime datetime_from = LONG_LONG_MIN,
-        DateTime datetime_to = LONG_LONG_MAX,
+        DateTime datetime_from = kDateTimeMin,
+        DateTime datetime_to = kDateTimeMax,
         int depth_limit = 2);
     std::optional<Path> QueryMinimumTimePath(
         int airport_from,
         int airport_to,
-        DateTime datetime_from = LONG_LONG_MIN,
-        DateTime datetime_to = LONG_LONG_MAX);
+        DateTime datetime_from = kDateTimeMin,
+        DateTime datetime_to = kDateTimeMax);
     std::optional<Path> QueryMinimumCostPath(
         int airport_from,
         int airport_to,
-        DateTime datetime_from = LONG_LONG_MIN,
-        DateTime datetime_to = LONG_LONG_MAX);
+        DateTime datetime_from = kDateTimeMin,
+        DateTime datetime_to = kDateTimeMax);
+    // The earliest arrival for every departure in the window, as the
+    // (departure, arrival) pairs of the journeys that no other one beats.
+    ConnectionScan::Profile QueryArrivalProfile(
+        int airport_from,
+        int airport_to,
+        DateTime datetime_from = kDateTimeMin,
+        DateTime datetime_to = kDateTimeMax);
+
+    // Every path that no other one beats on arrival time, total price and
+    // number of flights at once, by arrival, then price. The fastest, the
+    // cheapest and the one with the fewest flights are among them.
+    PathList QueryParetoPaths(
+        int airport_from,
+        int airport_to,
+        DateTime datetime_from = kDateTimeMin,
+        DateTime datetime_to = kDateTimeMax);
+
+    // The path with the fewest changes between flight numbers, and of those the
+    // earliest arrival. Staying on board a flight number that flies on is no change.
+    std::optional<Path> QueryFewestTransfersPath(
+        int airport_from,
+        int airport_to,
+        DateTime datetime_from = kDateTimeMin,
+        DateTime datetime_to = kDateTimeMax);
 
    private:
-    Path ConvertPath(AbstractFlightGraph::Path path);
-    PathList ConvertPathList(AbstractFlightGraph::PathList path_list);
+    Path ConvertJourney(ConnectionScan::Journey journey);
+    Path ConvertPath(const FlatFlightGraph& search, FlatFlightGraph::Path path);
+    PathList ConvertPathList(const FlatFlightGraph& search, FlatFlightGraph::PathList path_list);
 };
@@ -0,0 +1,76 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+// On-disk layout of a FlightDatabase snapshot (.fdb).
+//
+// A snapshot is a header, a table of sections and the sections themselves.
+// Every section is a plain array stored at an 8-byte aligned offset from the
+// start of the file, so a mapped snapshot can be queried in place wherever it
+// lands in memory. The checksum covers every byte after the header.
+struct SnapshotHeader {
+    static constexpr char kMagic[8] = {'F', 'L', 'I', 'G', 'H', 'T', 'D', 'B'};
+    static constexpr uint32_t kVersion = 5;
+
+    char magic[8];
+    uint32_t version;
+    uint32_t section_count;
+    uint64_t file_size;
+    uint64_t checksum;
+    uint64_t record_count;
+    int32_t airport_min, airport_max;
+};
+
+enum class SnapshotSectionId : uint32_t {
+    AIRPORT_FROM = 1,
+    AIRPORT_TO,
+    DATETIME_FROM,
+    DATETIME_TO,
+    PRICE,
+    FROM_OFFSETS,
+    FROM_IDS,
+    FROM_DATETIMES,
+    TO_OFFSETS,
+    TO_IDS,
+    TO_DATETIMES,
+    ROUTE_ORIGINS,
+    ROUTE_DESTINATIONS,
+    ROUTE_OFFSETS,
+    ROUTE_IDS_BY_DEPARTURE,
+    ROUTE_IDS_BY_ARRIVAL,
+    ROUTE_DEPARTURES,
+    ROUTE_ARRIVALS,
+    FLIGHT_NUMBER
+};
+
+struct SnapshotSection {
+    SnapshotSectionId id;
+    uint32_t element_size;
+    uint64_t offset;
+    uint64_t count;
+};
+
+static_assert(sizeof(SnapshotHeader) % 8 == 0 && sizeof(SnapshotSection) % 8 == 0);
+
+// FNV-1a over 64-bit little-endian words; a trailing partial word is zero-padded.
+class SnapshotChecksum {
+   private:
+    uint64_t hash = 0xcbf29ce484222325ull;
+
+   public:
+    void Update(const void* data, size_t size) {
+        auto bytes = static_cast<const char*>(data);
+        for (; size >= 8; bytes += 8, size -= 8) {
+            uint64_t word;
+            std::memcpy(&word, bytes, 8);
+            hash = (hash ^ word) * 0x100000001b3ull;
+        }
+        if (size > 0) {
+            uint64_t word = 0;
+            std::memcpy(&word, bytes, size);
+            hash = (hash ^ word) * 0x100000001b3ull;
+        }
+    }
+    uint64_t Value() const { return hash; }
+};
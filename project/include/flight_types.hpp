@@ -1,10 +1,61 @@
 #pragma once
+#include <cstdint>
+#include <limits>
 #include <stdexcept>
+#include <string>
 
 using Key = int;
 using Airport = int;
-using DateTime = long long;
+// Minutes since 1970-01-01 00:00, so differences are real durations.
+using DateTime = int32_t;
 using Price = int;
+// The Flight NO. of a flight, shared by the flights of one service.
+using FlightNumber = int;
+// Airport ids as stored in the flight table columns.
+using CompactAirport = uint16_t;
+
+constexpr DateTime kDateTimeMin = std::numeric_limits<DateTime>::min();
+constexpr DateTime kDateTimeMax = std::numeric_limits<DateTime>::max();
+
+// Day count from 1970-01-01 in the proleptic Gregorian calendar; out-of-range
+// days and months roll over, e.g. 10/0/2017 is 9/30/2017.
+constexpr int64_t DaysFromCivil(int64_t year, int64_t month, int64_t day) {
+    year -= month <= 2;
+    auto era = (year >= 0 ? year : year - 399) / 400;
+    auto year_of_era = year - era * 400;
+    auto day_of_year = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+    auto day_of_era = year_of_era * 365 + year_of_era / 4 - year_of_era / 100 + day_of_year;
+    return era * 146097 + day_of_era - 719468;
+}
+
+// Computed in 64 bits, as a DateTime only spans the years 1970 ± 4083 or so;
+// a time outside that span, or one of the sentinels, throws.
+constexpr DateTime MakeDateTime(int year, int month, int day, int hour, int minute) {
+    auto minutes = DaysFromCivil(year, month, day) * 24 * 60 + int64_t(hour) * 60 + minute;
+    if (minutes <= kDateTimeMin || minutes >= kDateTimeMax)
+        throw std::out_of_range("Date " + std::to_string(month) + "/" + std::to_string(day) + "/" +
+                                std::to_string(year) + " out of range");
+    return DateTime(minutes);
+}
+
+struct CivilDateTime {
+    int year, month, day, hour, minute;
+};
+
+constexpr CivilDateTime CivilFromDateTime(DateTime datetime) {
+    auto days = datetime >= 0 ? datetime / (24 * 60) : (datetime - (24 * 60 - 1)) / (24 * 60);
+    auto minutes = datetime - days * 24 * 60;
+    days += 719468;
+    auto era = (days >= 0 ? days : days - 146096) / 146097;
+    auto day_of_era = days - era * 146097;
+    auto year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+    auto day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+    auto month_index = (5 * day_of_year + 2) / 153;
+    auto day = day_of_year - (153 * month_index + 2) / 5 + 1;
+    auto month = month_index < 10 ? month_index + 3 : month_index - 9;
+    auto year = year_of_era + era * 400 + (month <= 2);
+    return {year, month, day, minutes / 60, minutes % 60};
+}
 
 struct AirportRange {
     Airport min, max;
@@ -26,3 +77,11 @@ struct FlightNodeKey {
         return airport == other.airport && no_sooner_than == other.no_sooner_than;
     }
 };
+
+// Fibonacci hashing of the packed key; take the high bits for a table index.
+struct FlightNodeKeyHash {
+    uint64_t operator()(const FlightNodeKey& key) const {
+        auto packed = uint64_t(uint32_t(key.airport)) << 32 | uint32_t(key.no_sooner_than);
+        return packed * 0x9e3779b97f4a7c15ull;
+    }
+};
@@ -0,0 +1,91 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <miniSTL/stl.hpp>
+#include "search_scratch.hpp"
+
+// A d-ary min-heap of node ids, ordered by their priorities in a scratch.
+//
+// The scratch also records where each node sits in the heap, so a node whose
+// priority drops is sifted up in place (decrease-key) instead of being pushed
+// a second time. The heap array is the scratch's, so it is reused across
+// queries. A wider heap is shallower, which trades a few more comparisons per
+// level for fewer levels and fewer cache misses.
+template <unsigned Arity = 4>
+class IndexedHeap {
+    static_assert(Arity >= 2);
+
+   public:
+    using NodeId = SearchScratch::NodeId;
+
+   private:
+    SearchScratch& scratch;
+    Vector<NodeId>& heap;
+
+    int Priority(size_t index) const { return scratch.GetPriority(heap[index]); }
+    void Place(size_t index, NodeId node) {
+        heap[index] = node;
+        scratch.SetHeapIndex(node, index);
+    }
+    void SiftUp(size_t index) {
+        auto node = heap[index];
+        auto priority = scratch.GetPriority(node);
+        while (index > 0) {
+            auto parent = (index - 1) / Arity;
+            if (Priority(parent) <= priority)
+                break;
+            Place(index, heap[parent]);
+            index = parent;
+        }
+        Place(index, node);
+    }
+    void SiftDown(size_t index) {
+        auto node = heap[index];
+        auto priority = scratch.GetPriority(node);
+        while (true) {
+            auto first = index * Arity + 1;
+            if (first >= heap.size())
+                break;
+            auto last = std::min<size_t>(first + Arity, heap.size());
+            auto best = first;
+            for (auto child = first + 1; child < last; child++)
+                if (Priority(child) < Priority(best))
+                    best = child;
+            if (Priority(best) >= priority)
+                break;
+            Place(index, heap[best]);
+            index = best;
+        }
+        Place(index, node);
+    }
+
+   public:
+    IndexedHeap(SearchScratch& scratch) : scratch(scratch), heap(scratch.Heap()) {
+        while (!heap.empty())
+            heap.pop_back();
+    }
+    IndexedHeap(const IndexedHeap&) = delete;
+    IndexedHeap& operator=(const IndexedHeap&) = delete;
+
+    bool Empty() const { return heap.empty(); }
+    size_t Size() const { return heap.size(); }
+    bool Contains(NodeId node) const { return scratch.GetHeapIndex(node) != SearchScratch::kNotQueued; }
+
+    void Push(NodeId node) {
+        heap.push_back(node);
+        SiftUp(heap.size() - 1);
+    }
+    // Restores the order after the priority of a queued node dropped.
+    void DecreaseKey(NodeId node) { SiftUp(scratch.GetHeapIndex(node)); }
+    NodeId Pop() {
+        auto top = heap[0];
+        auto last = heap.back();
+        heap.pop_back();
+        scratch.SetHeapIndex(top, SearchScratch::kNotQueued);
+        if (!heap.empty()) {
+            heap[0] = last;
+            SiftDown(0);
+        }
+        return top;
+    }
+};
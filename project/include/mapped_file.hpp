@@ -0,0 +1,23 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+// Read-only view of a whole file. On POSIX systems the file is mmap'ed, so
+// parsers can work on the page cache directly without copying it first.
+class MappedFile {
+   private:
+    const char* data = nullptr;
+    size_t size = 0;
+    bool mapped = false;
+
+   public:
+    MappedFile(std::string filename);
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* Data() const { return data; }
+    size_t Size() const { return size; }
+    std::string_view View() const { return {data, size}; }
+};
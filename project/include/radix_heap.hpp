@@ -0,0 +1,83 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <miniSTL/stl.hpp>
+#include "search_scratch.hpp"
+
+// A monotone radix heap of node ids, ordered by their priorities in a scratch.
+//
+// It serves Dijkstra with non-negative integer weights, where no priority
+// pushed is below the last one popped. An entry goes to the bucket of the
+// highest bit in which its priority differs from the last popped one; a pop
+// from an empty bucket 0 moves the lowest non-empty bucket down, and each
+// entry only ever moves to lower buckets, so operations are amortised O(1)
+// per bit of the priority range. Decrease-key pushes a second entry and the
+// stale one is skipped when it comes up. The buckets are the scratch's.
+class RadixHeap {
+   public:
+    using NodeId = SearchScratch::NodeId;
+
+   private:
+    SearchScratch& scratch;
+    uint32_t last = 0;
+    size_t queued = 0;
+
+    size_t BucketOf(int priority) const {
+        auto bits = uint32_t(priority) ^ last;
+        return bits == 0 ? 0 : std::bit_width(bits);
+    }
+    void Insert(int priority, NodeId node) { scratch.Bucket(BucketOf(priority)).push_back({priority, node}); }
+    // Refills bucket 0 from the lowest non-empty bucket.
+    void Redistribute() {
+        auto index = size_t(1);
+        while (scratch.Bucket(index).empty())
+            index++;
+        auto& bucket = scratch.Bucket(index);
+        auto lowest = bucket[0].priority;
+        for (auto& entry : bucket)
+            lowest = std::min(lowest, entry.priority);
+        last = uint32_t(lowest);
+        for (auto& entry : bucket)
+            Insert(entry.priority, entry.node);
+        while (!bucket.empty())
+            bucket.pop_back();
+    }
+
+   public:
+    RadixHeap(SearchScratch& scratch) : scratch(scratch) {
+        for (size_t index = 0; index < SearchScratch::kQueueBuckets; index++)
+            while (!scratch.Bucket(index).empty())
+                scratch.Bucket(index).pop_back();
+    }
+    RadixHeap(const RadixHeap&) = delete;
+    RadixHeap& operator=(const RadixHeap&) = delete;
+
+    bool Empty() const { return queued == 0; }
+    size_t Size() const { return queued; }
+
+    void Push(NodeId node) {
+        Insert(scratch.GetPriority(node), node);
+        queued++;
+    }
+    void DecreaseKey(NodeId node) { Insert(scratch.GetPriority(node), node); }
+    // A node of the lowest priority, left in the heap.
+    NodeId Top() {
+        while (true) {
+            if (scratch.Bucket(0).empty())
+                Redistribute();
+            auto entry = scratch.Bucket(0).back();
+            // An entry whose node has dropped since is stale.
+            if (entry.priority == scratch.GetPriority(entry.node))
+                return entry.node;
+            scratch.Bucket(0).pop_back();
+        }
+    }
+    NodeId Pop() {
+        auto node = Top();
+        scratch.Bucket(0).pop_back();
+        queued--;
+        return node;
+    }
+};
@@ -0,0 +1,79 @@
+#pragma once
+#include <climits>
+#include <memory>
+#include <miniSTL/stl.hpp>
+#include <optional>
+#include <span>
+#include "flight_database.hpp"
+#include "flight_types.hpp"
+
+// Round-based routing (RAPTOR) over the trips of a database, built once and
+// shared by every query.
+//
+// A trip is a run of flights with the same Flight NO., each leaving from
+// where the one before landed and no sooner; a ride is part of one trip,
+// boarded at one stop and left at a later one. A route is the trips that
+// call at the same airports in the same order, none overtaking another, so
+// the trips are sorted by their time at every stop. Times are stored stop by
+// stop, the trips of a stop side by side, so the earliest trip to catch at a
+// stop is a binary search over one array.
+//
+// Round k scans, once each, the routes through the airports whose arrival
+// improved in round k - 1, and gives the earliest arrival at every airport
+// with at most k rides. With one flight per trip, as in a schedule without
+// repeated flight numbers, a ride is a flight and round k answers what
+// `depth_limit` k does for EnumerateAllPaths.
+class Raptor {
+   public:
+    using Journey = std::shared_ptr<List<::Key>>;
+    using JourneyList = std::shared_ptr<List<Journey>>;
+
+    struct Route {
+        // The stops are [first_stop, first_stop + stop_count) of route_stops.
+        uint32_t first_stop, stop_count;
+        // Trip t at stop i is first_time + i * trip_count + t of the time
+        // columns; its flight from stop i is first_flight + i * trip_count + t.
+        uint32_t first_time, first_flight, trip_count;
+    };
+    // A route through an airport and the index of the airport among its stops.
+    struct RouteStop {
+        uint32_t route, stop;
+    };
+
+   private:
+    ::AirportRange airport_range;
+    Vector<Route> routes;
+    Vector<CompactAirport> route_stops;
+    Vector<DateTime> arrivals, departures;
+    Vector<::Key> flights;
+    // The routes that can be boarded at the i-th airport are
+    // [airport_offsets[i], airport_offsets[i + 1]) of airport_routes.
+    Vector<uint32_t> airport_offsets;
+    Vector<RouteStop> airport_routes;
+
+    // The journey of every round in which the arrival at `airport_to` improves.
+    JourneyList Run(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to,
+                    int max_rides, bool first_only) const;
+
+   public:
+    Raptor(const FlightDatabase& flight_database);
+    Raptor(const Raptor&) = delete;
+    Raptor& operator=(const Raptor&) = delete;
+
+    size_t RouteCount() const { return routes.size(); }
+    size_t TripCount() const;
+    std::span<const Route> Routes() const { return {routes.data(), routes.size()}; }
+    std::span<const CompactAirport> Stops(const Route& route) const { return {route_stops.data() + route.first_stop, route.stop_count}; }
+
+    // Journeys that leave `airport_from` no sooner than `datetime_from` and
+    // land at `airport_to` no later than `datetime_to`: for each number of
+    // rides up to `max_rides` that lands sooner than any with fewer rides,
+    // the earliest arrival with that many. Fewest rides first. With
+    // `max_rides` 0 only a journey to the same airport is found; a negative
+    // one throws std::invalid_argument.
+    JourneyList Journeys(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to,
+                         int max_rides = INT_MAX) const;
+    // The first of them, found without the rounds after it: the journey with
+    // the fewest transfers, and of those the earliest arrival.
+    std::optional<Journey> FewestTransfers(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to) const;
+};
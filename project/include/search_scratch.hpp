@@ -0,0 +1,87 @@
+#pragma once
+#include <climits>
+#include <cstdint>
+#include <memory>
+#include <miniSTL/stl.hpp>
+
+// Search state of one query, as parallel arrays indexed by node id.
+//
+// Every slot carries the generation that last wrote it, and a slot from an
+// older generation reads as untouched, so Reset costs O(1) instead of a pass
+// over every node. Scratches are recycled through a per-thread pool.
+class SearchScratch {
+   public:
+    using NodeId = uint32_t;
+    static constexpr NodeId kNoNode = UINT32_MAX;
+    // The heap index of a node that is not in the heap.
+    static constexpr uint32_t kNotQueued = UINT32_MAX;
+
+    enum class Status : uint8_t {
+        UNDISCOVERED,
+        DISCOVERED,
+        VISITED
+    };
+
+    // A node on the explicit stack of a depth-first search, with the rest of
+    // its edges still to try.
+    struct Frame {
+        NodeId node;
+        uint32_t next_edge, end_edge;
+        int depth_limit;
+    };
+
+    // An entry of a queue that keeps its own copy of the priority.
+    struct QueueEntry {
+        int priority;
+        NodeId node;
+    };
+    static constexpr size_t kQueueBuckets = 33;
+
+   private:
+    uint32_t generation = 0;
+    Vector<uint32_t> generations;
+    Vector<Status> status;
+    Vector<int> priority;
+    Vector<NodeId> parent;
+    Vector<uint32_t> heap_index;
+    Vector<Frame> stack;
+    Vector<NodeId> heap;
+    Vector<QueueEntry> buckets[kQueueBuckets];
+
+    void Touch(NodeId node) {
+        if (generations[node] == generation)
+            return;
+        generations[node] = generation;
+        status[node] = Status::UNDISCOVERED;
+        priority[node] = INT_MAX;
+        parent[node] = kNoNode;
+        heap_index[node] = kNotQueued;
+    }
+
+   public:
+    // Forgets the previous query and makes room for `size` nodes.
+    void Reset(size_t size);
+    // Makes room for node ids below `size` without forgetting anything.
+    void Reserve(size_t size);
+    size_t Size() const { return generations.size(); }
+
+    Status GetStatus(NodeId node) const { return generations[node] == generation ? status[node] : Status::UNDISCOVERED; }
+    int GetPriority(NodeId node) const { return generations[node] == generation ? priority[node] : INT_MAX; }
+    NodeId GetParent(NodeId node) const { return generations[node] == generation ? parent[node] : kNoNode; }
+    uint32_t GetHeapIndex(NodeId node) const { return generations[node] == generation ? heap_index[node] : kNotQueued; }
+    void SetStatus(NodeId node, Status value) { Touch(node), status[node] = value; }
+    void SetPriority(NodeId node, int value) { Touch(node), priority[node] = value; }
+    void SetParent(NodeId node, NodeId value) { Touch(node), parent[node] = value; }
+    void SetHeapIndex(NodeId node, uint32_t value) { Touch(node), heap_index[node] = value; }
+
+    // Kept across queries so deep searches stop allocating once warmed up.
+    // A search pops what it pushes; Vector::clear would release the storage.
+    Vector<Frame>& Stack() { return stack; }
+    Vector<NodeId>& Heap() { return heap; }
+    Vector<QueueEntry>& Bucket(size_t index) { return buckets[index]; }
+
+    // Takes a scratch from the pool of the calling thread; it goes back to
+    // that pool when the last reference is dropped, from any thread, or is
+    // deleted if the thread has exited by then.
+    static std::shared_ptr<SearchScratch> Acquire();
+};
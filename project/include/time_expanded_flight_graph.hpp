@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <miniSTL/stl.hpp>
+#include <optional>
+#include <span>
+#include "flight_database.hpp"
+#include "flight_types.hpp"
+
+// Immutable time-expanded flight graph, built once per database and shared by
+// every query.
+//
+// A node is an arrival event (airport, time); the nodes of an airport are the
+// ids [node_offsets[i], node_offsets[i + 1]) in time order. An edge is a
+// flight; the edges of an airport are its departures in the order of the
+// departure bucket index. The edges of a node are the departures of its
+// airport no sooner than its time, which is a suffix of the airport's edges,
+// so one CSR array serves every node. Edge data are parallel columns.
+class TimeExpandedFlightGraph {
+   public:
+    using NodeId = uint32_t;
+    using EdgeId = uint32_t;
+    static constexpr NodeId kNoNode = UINT32_MAX;
+
+    struct EdgeRange {
+        EdgeId begin, end;
+    };
+
+   private:
+    ::AirportRange airport_range;
+
+    Vector<uint32_t> node_offsets;
+    Vector<CompactAirport> node_airport;
+    Vector<DateTime> node_datetime;
+    Vector<EdgeId> node_first_edge;
+
+    Vector<uint32_t> edge_offsets;
+    Vector<::Key> edge_record;
+    Vector<DateTime> edge_departure;
+    Vector<DateTime> edge_arrival;
+    Vector<NodeId> edge_target;
+    Vector<Price> edge_price;
+    DateTime earliest_departure = kDateTimeMax;
+
+    EdgeId FirstEdgeFrom(Airport airport, DateTime no_sooner_than) const;
+
+   public:
+    TimeExpandedFlightGraph(const FlightDatabase& flight_database);
+    TimeExpandedFlightGraph(const TimeExpandedFlightGraph&) = delete;
+    TimeExpandedFlightGraph& operator=(const TimeExpandedFlightGraph&) = delete;
+
+    ::AirportRange AirportRange() const { return airport_range; }
+    size_t NodeCount() const { return node_datetime.size(); }
+    size_t EdgeCount() const { return edge_target.size(); }
+    DateTime EarliestDeparture() const { return earliest_departure; }
+
+    FlightNodeKey Key(NodeId node) const { return {node_airport[node], node_datetime[node]}; }
+    std::optional<NodeId> FindNode(FlightNodeKey key) const;
+    // The arrival nodes of `airport`, as the id range [first, second).
+    std::pair<NodeId, NodeId> NodesOf(Airport airport) const;
+    EdgeRange EdgesOf(NodeId node) const;
+    // The edges of a node with this key, whether or not the node exists.
+    EdgeRange EdgesOf(FlightNodeKey key) const;
+
+    std::span<const ::Key> EdgeRecordColumn() const { return {edge_record.data(), edge_record.size()}; }
+    std::span<const DateTime> EdgeArrivalColumn() const { return {edge_arrival.data(), edge_arrival.size()}; }
+    std::span<const NodeId> EdgeTargetColumn() const { return {edge_target.data(), edge_target.size()}; }
+    std::span<const Price> EdgePriceColumn() const { return {edge_price.data(), edge_price.size()}; }
+};
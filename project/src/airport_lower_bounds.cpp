@@ -0,0 +1,88 @@
+#include "../include/airport_lower_bounds.hpp"
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <utility>
+
+AirportLowerBounds::AirportLowerBounds(const FlightDatabase& flight_database)
+    : airport_range(flight_database.AirportRange()) {
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    auto price = flight_database.PriceColumn();
+    auto datetime_from = flight_database.DateTimeFromColumn();
+    auto datetime_to = flight_database.DateTimeToColumn();
+
+    // The routes by origin, then counted into rows by destination.
+    struct Route {
+        CompactAirport origin, destination;
+        int price, time;
+    };
+    auto routes = std::vector<Route>();
+    offsets.resize(airports + 1, 0);
+    for (auto origin = airport_range.min; origin <= airport_range.max; origin++)
+        for (auto destination : flight_database.QueryRouteDestinations(origin)) {
+            auto route = Route{CompactAirport(origin), destination, INT_MAX, INT_MAX};
+            for (auto id : flight_database.QueryRecordIdsByRoute(origin, destination)) {
+                route.price = std::min(route.price, price[id - 1]);
+                route.time = std::min(route.time, datetime_to[id - 1] - datetime_from[id - 1]);
+            }
+            routes.push_back(route);
+            offsets[destination - airport_range.min + 1]++;
+        }
+    for (size_t i = 0; i < airports; i++)
+        offsets[i + 1] += offsets[i];
+    origins.resize(routes.size(), 0);
+    min_price.resize(routes.size(), 0);
+    min_time.resize(routes.size(), 0);
+    auto next = std::vector<uint32_t>(offsets.begin(), offsets.end() - 1);
+    for (auto& route : routes) {
+        auto slot = next[route.destination - airport_range.min]++;
+        origins[slot] = route.origin;
+        min_price[slot] = route.price;
+        min_time[slot] = route.time;
+    }
+    cache.resize(airports);
+}
+
+Vector<int> AirportLowerBounds::ReverseDijkstra(Airport destination, const Vector<int>& weights) const {
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    auto distance = Vector<int>();
+    distance.resize(airports, kUnreachable);
+    using Entry = std::pair<int, size_t>;
+    auto queue = std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>>();
+    distance[destination - airport_range.min] = 0;
+    queue.push({0, destination - airport_range.min});
+    while (!queue.empty()) {
+        auto [cost, airport] = queue.top();
+        queue.pop();
+        // A stale entry: the airport was settled through a cheaper one.
+        if (cost > distance[airport])
+            continue;
+        for (auto route = offsets[airport]; route < offsets[airport + 1]; route++) {
+            auto origin = origins[route] - airport_range.min;
+            if (cost + weights[route] < distance[origin]) {
+                distance[origin] = cost + weights[route];
+                queue.push({distance[origin], origin});
+            }
+        }
+    }
+    return distance;
+}
+
+std::shared_ptr<const AirportLowerBounds::Bounds> AirportLowerBounds::To(Airport destination) const {
+    airport_range.WithinOrThrow(destination);
+    auto index = destination - airport_range.min;
+    {
+        auto lock = std::lock_guard(mutex);
+        if (cache[index])
+            return cache[index];
+    }
+    auto bounds = std::make_shared<Bounds>();
+    auto price = ReverseDijkstra(destination, min_price);
+    auto time = ReverseDijkstra(destination, min_time);
+    bounds->price.swap(price);
+    bounds->time.swap(time);
+    auto lock = std::lock_guard(mutex);
+    if (!cache[index])
+        cache[index] = bounds;
+    return cache[index];
+}
@@ -0,0 +1,105 @@
+#include "../include/bidirectional_search.hpp"
+#include <algorithm>
+#include <climits>
+
+BidirectionalSearch::BidirectionalSearch(const FlightDatabase& flight_database)
+    : flight_database(flight_database), forward(SearchScratch::Acquire()), backward(SearchScratch::Acquire()) {}
+
+std::optional<BidirectionalSearch::Journey> BidirectionalSearch::MinimumCost(
+    Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to) {
+    auto airport_range = flight_database.AirportRange();
+    airport_range.WithinOrThrow(airport_from);
+    airport_range.WithinOrThrow(airport_to);
+    stats = {};
+    if (datetime_from > datetime_to)
+        return std::nullopt;
+    auto journey = std::make_shared<List<::Key>>();
+    if (airport_from == airport_to)
+        return journey;
+
+    // Flights are named by their index in the flight table, which is their id - 1.
+    using Flight = SearchScratch::NodeId;
+    constexpr auto kNone = SearchScratch::kNoNode;
+    auto origin = flight_database.AirportFromColumn();
+    auto destination = flight_database.AirportToColumn();
+    auto departure = flight_database.DateTimeFromColumn();
+    auto arrival = flight_database.DateTimeToColumn();
+    auto price = flight_database.PriceColumn();
+    forward->Reset(flight_database.RecordCount());
+    backward->Reset(flight_database.RecordCount());
+    auto forward_queue = RadixHeap(*forward);
+    auto backward_queue = RadixHeap(*backward);
+
+    auto best = INT_MAX;
+    auto meeting = kNone;
+    auto label = [&](SearchScratch& side, RadixHeap& queue, const SearchScratch& other, Flight flight, int base, Flight parent) {
+        if (side.GetStatus(flight) != SearchScratch::Status::UNDISCOVERED)
+            return;
+        auto value = base + price[flight];
+        side.SetPriority(flight, value);
+        side.SetParent(flight, parent);
+        side.SetStatus(flight, SearchScratch::Status::DISCOVERED);
+        queue.Push(flight);
+        if (other.GetStatus(flight) != SearchScratch::Status::UNDISCOVERED) {
+            // Both labels count the price of the flight they meet on.
+            auto total = value + other.GetPriority(flight) - price[flight];
+            if (total < best)
+                best = total, meeting = flight;
+        }
+    };
+
+    // The departures of the i-th airport from covered_from[i] on, and its
+    // arrivals before covered_to[i], are covered; kNone if no departure is.
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    auto covered_from = Vector<uint32_t>();
+    auto covered_to = Vector<uint32_t>();
+    covered_from.resize(airports, kNone);
+    covered_to.resize(airports, 0);
+    auto cover_departures = [&](Airport airport, DateTime not_before, int base, Flight parent) {
+        auto all = flight_database.QueryRecordIdsByAirportFrom(airport);
+        auto first = uint32_t(flight_database.QueryRecordIdsByAirportFrom(airport, not_before, kDateTimeMax).data() - all.data());
+        auto& covered = covered_from[airport - airport_range.min];
+        for (auto i = first; i < std::min<size_t>(covered, all.size()); i++)
+            if (arrival[all[i] - 1] <= datetime_to)
+                label(*forward, forward_queue, *backward, all[i] - 1, base, parent);
+        covered = std::min(covered, first);
+    };
+    auto cover_arrivals = [&](Airport airport, DateTime not_after, int base, Flight parent) {
+        auto all = flight_database.QueryRecordIdsByAirportTo(airport);
+        auto ids = flight_database.QueryRecordIdsByAirportTo(airport, kDateTimeMin, not_after);
+        auto last = uint32_t(ids.data() + ids.size() - all.data());
+        auto& covered = covered_to[airport - airport_range.min];
+        for (auto i = covered; i < last; i++)
+            if (departure[all[i] - 1] >= datetime_from)
+                label(*backward, backward_queue, *forward, all[i] - 1, base, parent);
+        covered = std::max(covered, last);
+    };
+
+    cover_departures(airport_from, datetime_from, 0, kNone);
+    cover_arrivals(airport_to, datetime_to, 0, kNone);
+    while (!forward_queue.Empty() && !backward_queue.Empty()) {
+        auto next_forward = forward->GetPriority(forward_queue.Top());
+        auto next_backward = backward->GetPriority(backward_queue.Top());
+        if (int64_t(next_forward) + next_backward >= best)
+            break;
+        if (next_forward <= next_backward) {
+            auto flight = forward_queue.Pop();
+            forward->SetStatus(flight, SearchScratch::Status::VISITED);
+            stats.forward++;
+            cover_departures(destination[flight], arrival[flight], next_forward, flight);
+        } else {
+            auto flight = backward_queue.Pop();
+            backward->SetStatus(flight, SearchScratch::Status::VISITED);
+            stats.backward++;
+            cover_arrivals(origin[flight], departure[flight], next_backward, flight);
+        }
+    }
+    if (meeting == kNone)
+        return std::nullopt;
+
+    for (auto flight = meeting; flight != kNone; flight = forward->GetParent(flight))
+        journey->push_front(::Key(flight + 1));
+    for (auto flight = backward->GetParent(meeting); flight != kNone; flight = backward->GetParent(flight))
+        journey->push_back(::Key(flight + 1));
+    return journey;
+}
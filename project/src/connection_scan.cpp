@@ -0,0 +1,226 @@
+#include "../include/connection_scan.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <tuple>
+#include <vector>
+
+ConnectionScan::ConnectionScan(const FlightDatabase& flight_database)
+    : airport_range(flight_database.AirportRange()) {
+    auto airport_from = flight_database.AirportFromColumn();
+    auto airport_to = flight_database.AirportToColumn();
+    auto datetime_from = flight_database.DateTimeFromColumn();
+    auto datetime_to = flight_database.DateTimeToColumn();
+    connections.reserve(flight_database.RecordCount());
+    for (size_t i = 0; i < flight_database.RecordCount(); i++)
+        connections.push_back({datetime_from[i], datetime_to[i], airport_from[i], airport_to[i], ::Key(i + 1)});
+    // Ties by id keep the scan, and so the journeys it picks, deterministic.
+    std::sort(connections.begin(), connections.end(), [](const Connection& a, const Connection& b) {
+        return std::tie(a.departure, a.id) < std::tie(b.departure, b.id);
+    });
+    auto price = flight_database.PriceColumn();
+    prices.reserve(connections.size());
+    for (auto& connection : connections)
+        prices.push_back(price[connection.id - 1]);
+}
+
+std::optional<ConnectionScan::Journey> ConnectionScan::EarliestArrival(
+    Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to) const {
+    airport_range.WithinOrThrow(airport_from);
+    airport_range.WithinOrThrow(airport_to);
+    if (datetime_from > datetime_to)
+        return std::nullopt;
+    auto journey = std::make_shared<List<::Key>>();
+    if (airport_from == airport_to)
+        return journey;
+
+    constexpr auto kNone = UINT32_MAX;
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    auto earliest = Vector<DateTime>();
+    auto reached_by = Vector<uint32_t>();
+    earliest.resize(airports, kDateTimeMax);
+    reached_by.resize(airports, kNone);
+    auto from = airport_from - airport_range.min, to = airport_to - airport_range.min;
+    earliest[from] = datetime_from;
+
+    auto first = std::lower_bound(connections.begin(), connections.end(), datetime_from,
+                                  [](const Connection& connection, DateTime datetime) { return connection.departure < datetime; });
+    for (auto i = size_t(first - connections.begin()); i < connections.size(); i++) {
+        auto& connection = connections[i];
+        // Later connections land no sooner than they leave.
+        if (connection.departure > datetime_to || connection.departure >= earliest[to])
+            break;
+        auto origin = connection.from - airport_range.min, destination = connection.to - airport_range.min;
+        if (earliest[origin] <= connection.departure && connection.arrival < earliest[destination]) {
+            earliest[destination] = connection.arrival;
+            reached_by[destination] = i;
+        }
+    }
+    if (earliest[to] > datetime_to)
+        return std::nullopt;
+
+    // Every leg lands no later than the next one leaves, so the walk back ends at the origin.
+    for (auto airport = to; airport != from;) {
+        auto& connection = connections[reached_by[airport]];
+        journey->push_front(connection.id);
+        airport = connection.from - airport_range.min;
+    }
+    return journey;
+}
+
+ConnectionScan::Profile ConnectionScan::ArrivalProfile(
+    Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to) const {
+    airport_range.WithinOrThrow(airport_from);
+    airport_range.WithinOrThrow(airport_to);
+    auto result = std::make_shared<Vector<ProfileEntry>>();
+    if (airport_from == airport_to || datetime_from > datetime_to)
+        return result;
+
+    // The profile of every airport to the destination, in order of
+    // decreasing departure, which is the order the reverse scan adds them.
+    // Arrivals decrease with them, or the later entry would dominate.
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    auto profiles = std::vector<std::vector<ProfileEntry>>(airports);
+    auto to = airport_to - airport_range.min;
+    auto by_departure = [](const Connection& connection, DateTime datetime) { return connection.departure < datetime; };
+    auto first = std::lower_bound(connections.begin(), connections.end(), datetime_from, by_departure);
+    auto last = std::upper_bound(connections.begin(), connections.end(), datetime_to,
+                                 [](DateTime datetime, const Connection& connection) { return datetime < connection.departure; });
+    for (auto connection = last; connection != first;) {
+        connection--;
+        // Journeys that come back to the destination are never better.
+        if (connection->arrival > datetime_to || connection->from == airport_to)
+            continue;
+        auto destination = connection->to - airport_range.min;
+        auto arrival = kDateTimeMax;
+        if (destination == to) {
+            arrival = connection->arrival;
+        } else {
+            // The soonest landing among the journeys leaving no sooner than this one lands.
+            auto& onward = profiles[destination];
+            auto next = std::partition_point(onward.begin(), onward.end(), [&](const ProfileEntry& entry) {
+                return entry.departure >= connection->arrival;
+            });
+            if (next != onward.begin())
+                arrival = std::prev(next)->arrival;
+        }
+        if (arrival == kDateTimeMax)
+            continue;
+        auto& profile = profiles[connection->from - airport_range.min];
+        if (!profile.empty() && profile.back().arrival <= arrival)
+            continue;
+        if (!profile.empty() && profile.back().departure == connection->departure)
+            profile.back().arrival = arrival;
+        else
+            profile.push_back({connection->departure, arrival});
+    }
+
+    auto& profile = profiles[airport_from - airport_range.min];
+    result->reserve(profile.size());
+    for (auto entry = profile.rbegin(); entry != profile.rend(); entry++)
+        result->push_back(*entry);
+    return result;
+}
+
+ConnectionScan::JourneyList ConnectionScan::ParetoJourneys(
+    Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to,
+    const AirportLowerBounds::Bounds* bounds) const {
+    airport_range.WithinOrThrow(airport_from);
+    airport_range.WithinOrThrow(airport_to);
+    auto result = std::make_shared<List<Journey>>();
+    if (datetime_from > datetime_to)
+        return result;
+    if (airport_from == airport_to) {
+        result->push_back(std::make_shared<List<::Key>>());
+        return result;
+    }
+
+    // Labels live until the query ends; bags and the queue name them by index.
+    struct Label {
+        DateTime arrival;
+        Price price;
+        int legs;
+        uint32_t connection, parent;
+    };
+    constexpr auto kNone = UINT32_MAX;
+    auto labels = std::vector<Label>{{datetime_from, 0, 0, kNone, kNone}};
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    auto bags = std::vector<std::vector<uint32_t>>(airports);
+    auto from = airport_from - airport_range.min, to = airport_to - airport_range.min;
+    bags[from].push_back(0);
+    // Every label in a bag landed no later than one still in the air, so a
+    // label the bag beats on price and legs is beaten on all three.
+    auto beats = [](const Label& a, const Label& b) { return a.price <= b.price && a.legs <= b.legs; };
+    auto beaten = [&](size_t airport, const Label& label) {
+        return std::any_of(bags[airport].begin(), bags[airport].end(), [&](uint32_t other) { return beats(labels[other], label); });
+    };
+    // Whatever the label becomes by the destination, if it gets there in time.
+    auto hopeless = [&](size_t airport, Label label) {
+        if (!bounds)
+            return false;
+        // Widened, as the bound may be kUnreachable.
+        if (int64_t(label.arrival) + bounds->time[airport] > datetime_to)
+            return true;
+        label.price += bounds->price[airport];
+        label.legs += airport != size_t(to);
+        return beaten(to, label);
+    };
+    // Labels still in the air, by arrival.
+    using Landing = std::pair<DateTime, uint32_t>;
+    auto in_air = std::priority_queue<Landing, std::vector<Landing>, std::greater<Landing>>();
+    auto found = std::vector<uint32_t>();
+    auto land = [&](uint32_t index) {
+        auto label = labels[index];
+        auto airport = connections[label.connection].to - airport_range.min;
+        if (beaten(airport, label))
+            return;
+        auto& bag = bags[airport];
+        bag.erase(std::remove_if(bag.begin(), bag.end(), [&](uint32_t other) { return beats(label, labels[other]); }), bag.end());
+        bag.push_back(index);
+        if (airport != to)
+            return;
+        // Only a label that landed at the same time can be beaten by a later one.
+        found.erase(std::remove_if(found.begin(), found.end(), [&](uint32_t other) {
+                        return labels[other].arrival == label.arrival && beats(label, labels[other]);
+                    }),
+                    found.end());
+        found.push_back(index);
+    };
+
+    auto first = std::lower_bound(connections.begin(), connections.end(), datetime_from,
+                                  [](const Connection& connection, DateTime datetime) { return connection.departure < datetime; });
+    for (auto i = size_t(first - connections.begin()); i < connections.size(); i++) {
+        auto& connection = connections[i];
+        if (connection.departure > datetime_to)
+            break;
+        while (!in_air.empty() && in_air.top().first <= connection.departure) {
+            land(in_air.top().second);
+            in_air.pop();
+        }
+        // Journeys that come back to the destination are never better.
+        if (connection.arrival > datetime_to || connection.from == airport_to)
+            continue;
+        auto destination = connection.to - airport_range.min;
+        for (auto index : bags[connection.from - airport_range.min]) {
+            auto label = Label{connection.arrival, labels[index].price + prices[i], labels[index].legs + 1, uint32_t(i), index};
+            if (beaten(destination, label) || beaten(to, label) || hopeless(destination, label))
+                continue;
+            labels.push_back(label);
+            in_air.push({label.arrival, uint32_t(labels.size() - 1)});
+        }
+    }
+    for (; !in_air.empty(); in_air.pop())
+        land(in_air.top().second);
+
+    std::sort(found.begin(), found.end(), [&](uint32_t a, uint32_t b) {
+        return std::tie(labels[a].arrival, labels[a].price, labels[a].legs) < std::tie(labels[b].arrival, labels[b].price, labels[b].legs);
+    });
+    for (auto index : found) {
+        auto journey = std::make_shared<List<::Key>>();
+        for (; labels[index].connection != kNone; index = labels[index].parent)
+            journey->push_front(connections[labels[index].connection].id);
+        result->push_back(journey);
+    }
+    return result;
+}
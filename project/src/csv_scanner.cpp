@@ -0,0 +1,201 @@
+#include "../include/csv_scanner.hpp"
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define CSV_SCANNER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(CSV_SCANNER_X86) && defined(__GNUC__)
+#define CSV_SCANNER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define CSV_SCANNER_TARGET(isa)
+#endif
+
+using SplitLineFunction = int (*)(const char*, const char*, const char**, int);
+
+// Handles the bytes after the last full block one at a time.
+static int SplitTail(const char* cursor, const char* end, const char** delimiters, int count, int max_fields) {
+    for (; cursor != end; cursor++) {
+        if (*cursor == '\n') {
+            delimiters[count++] = cursor;
+            return count;
+        }
+        if (*cursor == ',' && count < max_fields - 1)
+            delimiters[count++] = cursor;
+    }
+    delimiters[count++] = end;
+    return count;
+}
+
+static int SplitLineScalar(const char* begin, const char* end, const char** delimiters, int max_fields) {
+    return SplitTail(begin, end, delimiters, 0, max_fields);
+}
+
+#ifdef CSV_SCANNER_X86
+// Bit i of the mask is set when block[i] is ',' or '\n'.
+CSV_SCANNER_TARGET("sse2")
+static inline uint64_t DelimiterMaskSSE2(const char* block) {
+    auto comma = _mm_set1_epi8(',');
+    auto newline = _mm_set1_epi8('\n');
+    auto mask = uint64_t(0);
+    for (int i = 0; i < 4; i++) {
+        auto bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + 16 * i));
+        auto hits = _mm_or_si128(_mm_cmpeq_epi8(bytes, comma), _mm_cmpeq_epi8(bytes, newline));
+        mask |= uint64_t(uint16_t(_mm_movemask_epi8(hits))) << (16 * i);
+    }
+    return mask;
+}
+
+CSV_SCANNER_TARGET("avx2")
+static inline uint64_t DelimiterMaskAVX2(const char* block) {
+    auto comma = _mm256_set1_epi8(',');
+    auto newline = _mm256_set1_epi8('\n');
+    auto low = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+    auto high = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+    auto low_hits = _mm256_or_si256(_mm256_cmpeq_epi8(low, comma), _mm256_cmpeq_epi8(low, newline));
+    auto high_hits = _mm256_or_si256(_mm256_cmpeq_epi8(high, comma), _mm256_cmpeq_epi8(high, newline));
+    return uint64_t(uint32_t(_mm256_movemask_epi8(low_hits))) |
+           uint64_t(uint32_t(_mm256_movemask_epi8(high_hits))) << 32;
+}
+
+// Records the delimiters flagged in `mask`; returns true once the line's '\n' is found.
+static inline bool ConsumeMask(const char* block, uint64_t mask, const char** delimiters, int& count, int max_fields) {
+    for (; mask != 0; mask &= mask - 1) {
+        auto cursor = block + std::countr_zero(mask);
+        if (*cursor == '\n') {
+            delimiters[count++] = cursor;
+            return true;
+        }
+        if (count < max_fields - 1)
+            delimiters[count++] = cursor;
+    }
+    return false;
+}
+
+CSV_SCANNER_TARGET("sse2")
+static int SplitLineSSE2(const char* begin, const char* end, const char** delimiters, int max_fields) {
+    auto count = 0;
+    auto block = begin;
+    for (; end - block >= 64; block += 64)
+        if (ConsumeMask(block, DelimiterMaskSSE2(block), delimiters, count, max_fields))
+            return count;
+    return SplitTail(block, end, delimiters, count, max_fields);
+}
+
+CSV_SCANNER_TARGET("avx2")
+static int SplitLineAVX2(const char* begin, const char* end, const char** delimiters, int max_fields) {
+    auto count = 0;
+    auto block = begin;
+    for (; end - block >= 64; block += 64)
+        if (ConsumeMask(block, DelimiterMaskAVX2(block), delimiters, count, max_fields))
+            return count;
+    return SplitTail(block, end, delimiters, count, max_fields);
+}
+#endif
+
+static bool CpuHasAVX2() {
+#if defined(CSV_SCANNER_X86) && defined(__GNUC__)
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#elif defined(CSV_SCANNER_X86) && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 1);
+    auto os_saves_ymm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+    __cpuidex(info, 7, 0);
+    return os_saves_ymm && (info[1] & (1 << 5));
+#else
+    return false;
+#endif
+}
+
+static SplitLineFunction Resolve(CsvScanner::Kind kind) {
+    switch (kind) {
+#ifdef CSV_SCANNER_X86
+        case CsvScanner::Kind::AVX2:
+            return SplitLineAVX2;
+        case CsvScanner::Kind::SSE2:
+            return SplitLineSSE2;
+#endif
+        default:
+            return SplitLineScalar;
+    }
+}
+
+static int SplitLineUnresolved(const char* begin, const char* end, const char** delimiters, int max_fields);
+
+// Both are constant-initialized, so a database loaded while other translation
+// units are still being initialized already sees a usable scanner. They are
+// atomic because the first use may come from several loader threads at once.
+static std::atomic<CsvScanner::Kind> active_kind = CsvScanner::Kind::SCALAR;
+static std::atomic<SplitLineFunction> active_split_line = SplitLineUnresolved;
+
+// Selects the detected kind once; threads that get here together wait for it.
+static void ResolveOnFirstUse() {
+    static const auto resolved = [] {
+        if (active_split_line.load() == SplitLineUnresolved)
+            CsvScanner::Select(CsvScanner::Detect());
+        return true;
+    }();
+    (void)resolved;
+}
+
+static int SplitLineUnresolved(const char* begin, const char* end, const char** delimiters, int max_fields) {
+    ResolveOnFirstUse();
+    return active_split_line.load()(begin, end, delimiters, max_fields);
+}
+
+CsvScanner::Kind CsvScanner::Detect() {
+#ifdef CSV_SCANNER_X86
+    return CpuHasAVX2() ? Kind::AVX2 : Kind::SSE2;
+#else
+    return Kind::SCALAR;
+#endif
+}
+
+CsvScanner::Kind CsvScanner::Active() {
+    if (active_split_line.load() == SplitLineUnresolved)
+        ResolveOnFirstUse();
+    return active_kind.load();
+}
+
+bool CsvScanner::Supported(Kind kind) {
+    switch (kind) {
+        case Kind::SCALAR:
+            return true;
+        case Kind::SSE2:
+            return Detect() != Kind::SCALAR;
+        case Kind::AVX2:
+            return Detect() == Kind::AVX2;
+    }
+    return false;
+}
+
+void CsvScanner::Select(Kind kind) {
+    if (!Supported(kind))
+        throw std::invalid_argument(Name(kind) + " is not supported by this CPU");
+    active_kind.store(kind);
+    active_split_line.store(Resolve(kind));
+}
+
+std::string CsvScanner::Name(Kind kind) {
+    switch (kind) {
+        case Kind::SCALAR:
+            return "scalar";
+        case Kind::SSE2:
+            return "SSE2";
+        case Kind::AVX2:
+            return "AVX2";
+    }
+    return "unknown";
+}
+
+int CsvScanner::SplitLine(const char* begin, const char* end, const char** delimiters, int max_fields) {
+    return active_split_line.load()(begin, end, delimiters, max_fields);
+}
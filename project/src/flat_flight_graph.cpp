@@ -0,0 +1,177 @@
+#include "../include/flat_flight_graph.hpp"
+#include <assert.h>
+#include <algorithm>
+
+FlatFlightGraph::FlatFlightGraph(std::shared_ptr<const TimeExpandedFlightGraph> graph, Weight weight)
+    : graph(graph), weight(weight), scratch(SearchScratch::Acquire()) {
+    scratch->Reset(graph->NodeCount() + kLocalNodes);
+}
+
+FlatFlightGraph::NodeId FlatFlightGraph::GetNode(FlightNodeKey key) {
+    if (auto node = graph->FindNode(key))
+        return *node;
+    for (size_t i = 0; i < local_keys.size(); i++)
+        if (local_keys[i] == key)
+            return NodeId(graph->NodeCount() + i);
+    local_keys.push_back(key);
+    scratch->Reserve(NodeCount());
+    return NodeId(NodeCount() - 1);
+}
+
+FlightNodeKey FlatFlightGraph::Key(NodeId node) const {
+    return node < graph->NodeCount() ? graph->Key(node) : local_keys[node - graph->NodeCount()];
+}
+
+TimeExpandedFlightGraph::EdgeRange FlatFlightGraph::EdgesOf(NodeId node) const {
+    return node < graph->NodeCount() ? graph->EdgesOf(node) : graph->EdgesOf(Key(node));
+}
+
+int FlatFlightGraph::EdgeWeight(NodeId from, TimeExpandedFlightGraph::EdgeId edge) const {
+    switch (weight) {
+        case Weight::TIME:
+            // Times are measured from no sooner than the first flight, so a
+            // query from kDateTimeMin does not overflow. Every path from the
+            // source shifts by the same amount, which keeps their order.
+            return graph->EdgeArrivalColumn()[edge] - std::max(Key(from).no_sooner_than, graph->EarliestDeparture());
+        case Weight::PRICE:
+            return graph->EdgePriceColumn()[edge];
+        default:
+            return 0;
+    }
+}
+
+bool FlatFlightGraph::IsContinuousChild(NodeId parent, NodeId child) const {
+    auto parent_key = Key(parent), child_key = Key(child);
+    return parent_key.airport == child_key.airport && parent_key.no_sooner_than <= child_key.no_sooner_than;
+}
+
+void FlatFlightGraph::Discover(NodeId node, bool emit_event) {
+    assert(scratch->GetStatus(node) == Status::UNDISCOVERED);
+    scratch->SetStatus(node, Status::DISCOVERED);
+    if (emit_event)
+        OnNodeDiscovered.Invoke(node);
+}
+
+void FlatFlightGraph::Visit(NodeId node, bool emit_event) {
+    assert(scratch->GetStatus(node) == Status::DISCOVERED);
+    scratch->SetStatus(node, Status::VISITED);
+    if (emit_event)
+        OnNodeVisited.Invoke(node);
+}
+
+FlatFlightGraph::Path FlatFlightGraph::GetPath(NodeId node) const {
+    auto path = std::make_shared<List<NodeId>>();
+    for (; node != kNoNode; node = scratch->GetParent(node))
+        path->push_front(node);
+    return path;
+}
+
+void FlatFlightGraph::DFS(NodeId node, int depth_limit) {
+    auto visitor = EventVisitor(*this);
+    DFS(node, visitor, depth_limit);
+}
+
+void FlatFlightGraph::BFS(NodeId node) {
+    auto visitor = EventVisitor(*this);
+    BFS(node, visitor);
+}
+
+void FlatFlightGraph::PFS(NodeId node) {
+    auto visitor = EventVisitor(*this);
+    PFS(node, visitor);
+}
+
+namespace {
+
+// Records the DFS stack whenever a node that reaches `to` is visited.
+struct AllPathsVisitor : FlatFlightGraph::Visitor {
+    const FlatFlightGraph& search;
+    FlatFlightGraph::NodeId to;
+    Vector<FlatFlightGraph::NodeId> stack;
+    FlatFlightGraph::PathList result = std::make_shared<List<FlatFlightGraph::Path>>();
+
+    AllPathsVisitor(const FlatFlightGraph& search, FlatFlightGraph::NodeId to)
+        : search(search), to(to) {}
+    FlatFlightGraph::Control Discover(FlatFlightGraph::NodeId node) {
+        stack.push_back(node);
+        return FlatFlightGraph::Control::CONTINUE;
+    }
+    FlatFlightGraph::Control Visit(FlatFlightGraph::NodeId node) {
+        if (node == to || search.IsContinuousChild(node, to)) {
+            auto path = std::make_shared<List<FlatFlightGraph::NodeId>>();
+            for (auto node : stack)
+                path->push_back(node);
+            result->push_back(path);
+        }
+        stack.pop_back();
+        return FlatFlightGraph::Control::CONTINUE;
+    }
+};
+
+}  // namespace
+
+FlatFlightGraph::PathList FlatFlightGraph::AllPathsTo(NodeId from, NodeId to, int depth_limit) {
+    auto visitor = AllPathsVisitor(*this, to);
+    DFS(from, visitor, depth_limit);
+    return visitor.result;
+}
+
+namespace {
+
+// Stops the search at the first visited node that reaches `to`.
+struct BestPathVisitor : FlatFlightGraph::Visitor {
+    const FlatFlightGraph& search;
+    FlatFlightGraph::NodeId to;
+    std::optional<FlatFlightGraph::Path> result;
+
+    BestPathVisitor(const FlatFlightGraph& search, FlatFlightGraph::NodeId to)
+        : search(search), to(to) {}
+    FlatFlightGraph::Control Visit(FlatFlightGraph::NodeId node) {
+        if (!search.IsContinuousChild(node, to))
+            return FlatFlightGraph::Control::CONTINUE;
+        result = search.GetPath(node);
+        return FlatFlightGraph::Control::STOP;
+    }
+};
+
+}  // namespace
+
+std::optional<FlatFlightGraph::Path> FlatFlightGraph::BestPathTo(NodeId from, NodeId to) {
+    auto visitor = BestPathVisitor(*this, to);
+    PFS(from, visitor);
+    return visitor.result;
+}
+
+std::optional<FlatFlightGraph::Path> FlatFlightGraph::ShortestPathTo(NodeId from, NodeId to, Queue queue) {
+    auto visitor = BestPathVisitor(*this, to);
+    switch (queue) {
+        case Queue::BINARY_HEAP:
+            Dijkstra<IndexedHeap<2>>(from, visitor);
+            break;
+        case Queue::QUATERNARY_HEAP:
+            Dijkstra<IndexedHeap<4>>(from, visitor);
+            break;
+        case Queue::RADIX_HEAP:
+            Dijkstra<RadixHeap>(from, visitor);
+            break;
+    }
+    return visitor.result;
+}
+
+std::optional<FlatFlightGraph::Path> FlatFlightGraph::ShortestPathTo(NodeId from, NodeId to, const AirportLowerBounds::Bounds& bounds) {
+    auto visitor = BestPathVisitor(*this, to);
+    auto first = graph->AirportRange().min;
+    auto deadline = Key(to).no_sooner_than;
+    auto& lower_bounds = weight == Weight::PRICE ? bounds.price : bounds.time;
+    auto heuristic = [&](NodeId node) {
+        auto key = Key(node);
+        auto index = key.airport - first;
+        // Widened, as the deadline may be kDateTimeMax.
+        if (bounds.time[index] == AirportLowerBounds::kUnreachable ||
+            int64_t(key.no_sooner_than) + bounds.time[index] > deadline)
+            return kPruned;
+        return weight == Weight::NONE ? 0 : lower_bounds[index];
+    };
+    Dijkstra<RadixHeap>(from, visitor, heuristic);
+    return visitor.result;
+}
@@ -1,7 +1,16 @@
 #include "../include/flight_database.hpp"
 #include <assert.h>
 #include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <exception>
 #include <fstream>
+#include <limits>
+#include <thread>
+#include <tuple>
+#include <vector>
+#include "../include/csv_scanner.hpp"
+#include "../include/mapped_file.hpp"
 
 void FlightDatabase::LoadDatabase(std::string filename) {
     auto file = std::ifstream();
@@ -18,6 +27,209 @@ void FlightDatabase::LoadDatabase(std::string filename) {
     }
 }
 
+void FlightDatabase::LoadDatabaseMapped(std::string filename, int threads) {
+    auto file = MappedFile(filename);
+    auto text = file.View();
+    auto header_end = text.find('\n');
+    text = header_end == std::string_view::npos ? std::string_view() : text.substr(header_end + 1);
+    if (threads <= 1) {
+        records.reserve(std::count(text.begin(), text.end(), '\n') + 1);
+        ParseRecords(text, records);
+    } else {
+        LoadChunksInParallel(text, threads);
+    }
+}
+
+bool FlightDatabase::ParseRecords(std::string_view text, Vector<Record>& output) {
+    const char* delimiters[kFieldCount];
+    auto cursor = text.data();
+    auto end = text.data() + text.size();
+    while (cursor < end) {
+        auto fields = CsvScanner::SplitLine(cursor, end, delimiters, kFieldCount);
+        auto line_end = delimiters[fields - 1];
+        if (line_end != cursor && line_end[-1] == '\r')
+            delimiters[fields - 1] = line_end - 1;
+        if (fields == 1 && delimiters[0] == cursor)
+            return false;
+        output.push_back(ParseRecordInPlace(cursor, delimiters, fields));
+        // The last line may end at `end` rather than at a newline.
+        cursor = std::min(line_end + 1, end);
+    }
+    return true;
+}
+
+// Runs task(0), ..., task(count - 1) on separate threads, waits for all of
+// them and rethrows the first exception raised by any task.
+template <typename Task>
+static void RunOnThreads(int count, Task task) {
+    auto errors = Vector<std::exception_ptr>(count);
+    auto workers = std::vector<std::thread>();
+    workers.reserve(count);
+    for (int i = 0; i < count; i++)
+        workers.push_back(std::thread([&task, &errors, i]() {
+            try {
+                task(i);
+            } catch (...) {
+                errors[i] = std::current_exception();
+            }
+        }));
+    for (auto& worker : workers)
+        worker.join();
+    for (auto& error : errors)
+        if (error)
+            std::rethrow_exception(error);
+}
+
+void FlightDatabase::LoadChunksInParallel(std::string_view text, int threads) {
+    // Cut the table at newline boundaries so that every chunk holds whole lines.
+    auto bounds = Vector<size_t>();
+    bounds.push_back(0);
+    for (int i = 1; i < threads; i++) {
+        auto cut = text.find('\n', std::max(bounds.back(), text.size() * i / threads));
+        bounds.push_back(cut == std::string_view::npos ? text.size() : cut + 1);
+    }
+    bounds.push_back(text.size());
+
+    auto chunks = Vector<std::shared_ptr<Vector<Record>>>();
+    auto complete = Vector<bool>(threads, false);
+    for (int i = 0; i < threads; i++)
+        chunks.push_back(std::make_shared<Vector<Record>>());
+    RunOnThreads(threads, [&](int i) {
+        auto chunk = text.substr(bounds[i], bounds[i + 1] - bounds[i]);
+        chunks[i]->reserve(std::count(chunk.begin(), chunk.end(), '\n') + 1);
+        complete[i] = ParseRecords(chunk, *chunks[i]);
+    });
+
+    // An empty line ends the table, so later chunks are dropped just like the
+    // sequential loader would never have read them.
+    auto used = 0;
+    auto total = size_t(0);
+    while (used < threads) {
+        total += chunks[used]->size();
+        if (!complete[used++])
+            break;
+    }
+
+    // Merge in Flight ID order, so that record `id` ends up at `id - 1`. A
+    // thread claims a slot before writing it, so a repeated Flight ID in two
+    // chunks is caught instead of written twice at once.
+    records.resize(total);
+    auto claimed = std::vector<std::atomic<bool>>(total);
+    RunOnThreads(used, [&](int i) {
+        for (auto& record : *chunks[i]) {
+            if (record.id < 1 || size_t(record.id) > total)
+                throw std::runtime_error("Flight ID out of range: " + std::to_string(record.id));
+            if (claimed[record.id - 1].exchange(true, std::memory_order_relaxed))
+                throw std::runtime_error("Malformed record: duplicate Flight ID " + std::to_string(record.id));
+            records[record.id - 1] = record;
+        }
+    });
+    for (size_t i = 0; i < total; i++)
+        if (size_t(records[i].id) != i + 1)
+            throw std::runtime_error("Missing Flight ID: " + std::to_string(i + 1));
+}
+
+// Reads a number terminated by `delimiter` (or by the end of the input when
+// `delimiter` is 0) and moves `cursor` past the delimiter.
+template <typename T>
+static T ReadNumber(const char*& cursor, const char* end, char delimiter) {
+    auto value = T();
+    auto [next, error] = std::from_chars(cursor, end, value);
+    if (error != std::errc() || (delimiter == 0 ? next != end : next == end || *next != delimiter))
+        throw std::runtime_error("Malformed field: " + std::string(cursor, end));
+    cursor = delimiter == 0 ? next : next + 1;
+    return value;
+}
+
+static DateTime ParseDateTimeInPlace(const char*& cursor, const char* end, char delimiter) {
+    // 5/6/2017 12:20
+    auto month = ReadNumber<int>(cursor, end, '/');
+    auto day = ReadNumber<int>(cursor, end, '/');
+    auto year = ReadNumber<int>(cursor, end, ' ');
+    auto hour = ReadNumber<int>(cursor, end, ':');
+    auto minute = ReadNumber<int>(cursor, end, delimiter);
+    return MakeDateTime(year, month, day, hour, minute);
+}
+
+static inline unsigned Digit(char c) {
+    return unsigned(c) - '0';
+}
+
+// Reads one or two digits followed by `delimiter`.
+static inline bool DecodeShort(const char*& cursor, char delimiter, unsigned& value) {
+    auto high = Digit(cursor[0]);
+    if (high > 9)
+        return false;
+    if (cursor[1] == delimiter) {
+        value = high;
+        cursor += 2;
+        return true;
+    }
+    auto low = Digit(cursor[1]);
+    if (low > 9 || cursor[2] != delimiter)
+        return false;
+    value = high * 10 + low;
+    cursor += 3;
+    return true;
+}
+
+// Decodes the fixed `M/D/YYYY H:MM` layout of the schedule exports without
+// searching for separators. Returns false when the field has another shape.
+static bool DecodeDateTime(const char* begin, const char* end, DateTime& datetime) {
+    // The shortest form is 5/6/2017 0:00 and the longest 12/31/2017 23:59.
+    if (end - begin < 13 || end - begin > 16 || end[-3] != ':')
+        return false;
+    auto cursor = begin;
+    unsigned month, day, hour;
+    if (!DecodeShort(cursor, '/', month) || !DecodeShort(cursor, '/', day))
+        return false;
+    if (end - cursor < 9)
+        return false;
+    auto y0 = Digit(cursor[0]), y1 = Digit(cursor[1]), y2 = Digit(cursor[2]), y3 = Digit(cursor[3]);
+    if ((y0 | y1 | y2 | y3) > 9 || cursor[4] != ' ')
+        return false;
+    cursor += 5;
+    if (!DecodeShort(cursor, ':', hour) || cursor + 2 != end)
+        return false;
+    auto m0 = Digit(cursor[0]), m1 = Digit(cursor[1]);
+    if ((m0 | m1) > 9)
+        return false;
+    datetime = MakeDateTime(y0 * 1000 + y1 * 100 + y2 * 10 + y3, month, day, hour, m0 * 10 + m1);
+    return true;
+}
+
+template <typename T>
+static T ParseField(const char* begin, const char* end) {
+    auto value = T();
+    auto [next, error] = std::from_chars(begin, end, value);
+    if (error != std::errc() || next != end)
+        throw std::runtime_error("Malformed field: " + std::string(begin, end));
+    return value;
+}
+
+static DateTime ParseDateTimeField(const char* begin, const char* end) {
+    auto datetime = DateTime();
+    if (!DecodeDateTime(begin, end, datetime))
+        datetime = ParseDateTimeInPlace(begin, end, 0);
+    return datetime;
+}
+
+FlightDatabase::Record FlightDatabase::ParseRecordInPlace(const char* line, const char* const* delimiters, int fields) {
+    // Same layout as ParseRecord; delimiters[i] ends field i.
+    if (fields != kFieldCount)
+        throw std::runtime_error("Malformed record: " + std::string(line, delimiters[fields - 1]));
+    auto field = [&](int i) { return i == 0 ? line : delimiters[i - 1] + 1; };
+    auto record = Record();
+    record.id = ParseField<Key>(field(0), delimiters[0]);
+    record.flight_number = ParseField<FlightNumber>(field(3), delimiters[3]);
+    record.airport_from = ParseField<Airport>(field(4), delimiters[4]);
+    record.airport_to = ParseField<Airport>(field(5), delimiters[5]);
+    record.datetime_from = ParseDateTimeField(field(6), delimiters[6]);
+    record.datetime_to = ParseDateTimeField(field(7), delimiters[7]);
+    record.price = ParseField<Price>(field(10), delimiters[10]);
+    return record;
+}
+
 FlightDatabase::Record FlightDatabase::ParseRecord(std::string line) {
     // Flight ID,Departure date,Intl/Dome,Flight NO.,Departure airport,Arrival airport,Departure Time,Arrival Time,Airplane ID,Airplane Model,Air fares
     // 1,5/5/2017,Dome,346,48,50,5/5/2017 12:20,5/5/2017 15:10,30,1,666
@@ -26,6 +238,7 @@ FlightDatabase::Record FlightDatabase::ParseRecord(std::string line) {
     line = line.substr(line.find(',') + 1);
     line = line.substr(line.find(',') + 1);
     line = line.substr(line.find(',') + 1);
+    record.flight_number = std::stoi(line.substr(0, line.find(',')));
     line = line.substr(line.find(',') + 1);
     record.airport_from = std::stoi(line.substr(0, line.find(',')));
     line = line.substr(line.find(',') + 1);
@@ -41,28 +254,72 @@ FlightDatabase::Record FlightDatabase::ParseRecord(std::string line) {
     return record;
 }
 
-FlightDatabase::FlightDatabase(std::string filename) {
-    LoadDatabase(filename);
+FlightDatabase::FlightDatabase(std::string filename, LoadMode mode, int threads) {
+    if (mode == LoadMode::SNAPSHOT) {
+        LoadSnapshot(filename);
+        return;
+    }
+    if (mode == LoadMode::STREAM)
+        LoadDatabase(filename);
+    else
+        LoadDatabaseMapped(filename, threads);
+    InitColumns();
     InitAirportRange();
     InitAirportBucketIndex();
+    InitRouteIndex();
+}
+
+void FlightDatabase::InitColumns() {
+    column_storage = std::make_shared<ColumnStorage>();
+    auto& storage = *column_storage;
+    auto size = records.size();
+    storage.airport_from.reserve(size);
+    storage.airport_to.reserve(size);
+    storage.datetime_from.reserve(size);
+    storage.datetime_to.reserve(size);
+    storage.price.reserve(size);
+    storage.flight_number.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        auto& record = records[i];
+        if (size_t(record.id) != i + 1)
+            throw std::runtime_error("Flight ID " + std::to_string(record.id) + " out of order");
+        for (auto airport : {record.airport_from, record.airport_to})
+            if (airport < 0 || airport > std::numeric_limits<CompactAirport>::max())
+                throw std::out_of_range("Airport " + std::to_string(airport) + " does not fit the airport column");
+        storage.airport_from.push_back(record.airport_from);
+        storage.airport_to.push_back(record.airport_to);
+        storage.datetime_from.push_back(record.datetime_from);
+        storage.datetime_to.push_back(record.datetime_to);
+        storage.price.push_back(record.price);
+        storage.flight_number.push_back(record.flight_number);
+    }
+    records.clear();
+    columns.airport_from = {storage.airport_from.data(), size};
+    columns.airport_to = {storage.airport_to.data(), size};
+    columns.datetime_from = {storage.datetime_from.data(), size};
+    columns.datetime_to = {storage.datetime_to.data(), size};
+    columns.price = {storage.price.data(), size};
+    columns.flight_number = {storage.flight_number.data(), size};
 }
 
 DateTime FlightDatabase::ParseDateTime(std::string datetime) {
     // 5/6/2017 12:20
-    DateTime month = std::stoi(datetime.substr(0, datetime.find('/')));
+    auto month = std::stoi(datetime.substr(0, datetime.find('/')));
     datetime = datetime.substr(datetime.find('/') + 1);
-    DateTime day = std::stoi(datetime.substr(0, datetime.find('/')));
+    auto day = std::stoi(datetime.substr(0, datetime.find('/')));
     datetime = datetime.substr(datetime.find('/') + 1);
-    DateTime year = std::stoi(datetime.substr(0, datetime.find(' ')));
+    auto year = std::stoi(datetime.substr(0, datetime.find(' ')));
     datetime = datetime.substr(datetime.find(' ') + 1);
-    DateTime hour = std::stoi(datetime.substr(0, datetime.find(':')));
+    auto hour = std::stoi(datetime.substr(0, datetime.find(':')));
     datetime = datetime.substr(datetime.find(':') + 1);
-    DateTime minute = std::stoi(datetime);
-    return (year * 10000 + month * 100 + day) * 10000 + hour * 100 + minute;
+    auto minute = std::stoi(datetime);
+    return MakeDateTime(year, month, day, hour, minute);
 }
 
 FlightDatabase::Record FlightDatabase::QueryRecordById(Key id) const {
-    return records[id - 1];
+    auto i = id - 1;
+    return {id, columns.airport_from[i], columns.airport_to[i],
+            columns.datetime_from[i], columns.datetime_to[i], columns.price[i], columns.flight_number[i]};
 }
 
 FlightDatabase::Record
@@ -70,62 +327,174 @@ FlightDatabase::QueryRecordByAirportsAndArrivalTime(
     Airport airport_from,
     Airport airport_to,
     DateTime datetime_to) const {
-    auto subquery = QueryRecordIdsByAirportFrom(airport_from);
-    auto result = std::optional<Record>();
-    for (auto id : *subquery) {
-        auto record = QueryRecordById(id);
-        if (record.airport_to == airport_to && record.datetime_to == datetime_to) {
-            if (result.has_value())
-                throw std::runtime_error("Unique violation!");
-            result = record;
-        }
-    }
-    if (!result.has_value())
+    auto result = QueryRecordIdsByRouteArrival(airport_from, airport_to, datetime_to, datetime_to);
+    if (result.size() > 1)
+        throw std::runtime_error("Unique violation!");
+    if (result.empty())
         throw std::runtime_error("Record not found!");
-    return result.value();
+    return QueryRecordById(result[0]);
 }
 
-std::shared_ptr<Vector<Key>>
+std::span<const Key>
 FlightDatabase::QueryRecordIdsByAirportFrom(Airport airport) const {
-    return airport_from_bucket_index->Get(airport);
+    return airport_from_bucket_index.Get(airport);
 }
 
-std::shared_ptr<Vector<Key>>
+std::span<const Key>
 FlightDatabase::QueryRecordIdsByAirportTo(Airport airport) const {
-    return airport_to_bucket_index->Get(airport);
+    return airport_to_bucket_index.Get(airport);
+}
+
+std::span<const Key>
+FlightDatabase::QueryRecordIdsByAirportFrom(Airport airport, DateTime not_before, DateTime not_after) const {
+    return airport_from_bucket_index.Get(airport, not_before, not_after);
+}
+
+std::span<const Key>
+FlightDatabase::QueryRecordIdsByAirportTo(Airport airport, DateTime not_before, DateTime not_after) const {
+    return airport_to_bucket_index.Get(airport, not_before, not_after);
+}
+
+std::span<const Key>
+FlightDatabase::QueryRecordIdsByRoute(Airport airport_from, Airport airport_to) const {
+    return RouteDepartures(airport_from, airport_to).ids;
+}
+
+std::span<const Key>
+FlightDatabase::QueryRecordIdsByRoute(Airport airport_from, Airport airport_to, DateTime not_before, DateTime not_after) const {
+    return RouteDepartures(airport_from, airport_to).Slice(not_before, not_after);
+}
+
+std::span<const CompactAirport> FlightDatabase::QueryRouteDestinations(Airport airport_from) const {
+    airport_range.WithinOrThrow(airport_from);
+    auto index = airport_from - airport_range.min;
+    auto begin = route_index.origins[index];
+    return route_index.destinations.subspan(begin, route_index.origins[index + 1] - begin);
+}
+
+std::span<const Key>
+FlightDatabase::QueryRecordIdsByRouteArrival(Airport airport_from, Airport airport_to, DateTime not_before, DateTime not_after) const {
+    return RouteArrivals(airport_from, airport_to).Slice(not_before, not_after);
+}
+
+std::span<const Key> FlightDatabase::Bucket::Slice(DateTime not_before, DateTime not_after) const {
+    if (not_before > not_after)
+        return {};
+    auto begin = std::lower_bound(datetimes.begin(), datetimes.end(), not_before);
+    auto end = std::upper_bound(begin, datetimes.end(), not_after);
+    return ids.subspan(begin - datetimes.begin(), end - begin);
 }
 
 void FlightDatabase::InitAirportRange() {
-    airport_range.min = airport_range.max = records[0].airport_from;
-    for (auto record : records) {
-        airport_range.min = std::min(airport_range.min, record.airport_from);
-        airport_range.max = std::max(airport_range.max, record.airport_from);
-        airport_range.min = std::min(airport_range.min, record.airport_to);
-        airport_range.max = std::max(airport_range.max, record.airport_to);
-    }
+    airport_range.min = airport_range.max = columns.airport_from[0];
+    for (auto column : {columns.airport_from, columns.airport_to})
+        for (Airport airport : column) {
+            airport_range.min = std::min(airport_range.min, airport);
+            airport_range.max = std::max(airport_range.max, airport);
+        }
 }
 
 void FlightDatabase::InitAirportBucketIndex() {
-    airport_from_bucket_index =
-        std::make_shared<AbstractFlightGraphNodeContainer<Key>>(airport_range);
-    airport_to_bucket_index =
-        std::make_shared<AbstractFlightGraphNodeContainer<Key>>(airport_range);
-    for (auto& record : records) {
-        airport_from_bucket_index->Add(record.airport_from, record.datetime_from, record.id);
-        airport_to_bucket_index->Add(record.airport_to, record.datetime_to, record.id);
+    auto ids = Vector<Key>();
+    ids.reserve(RecordCount());
+    for (Key id = 1; size_t(id) <= RecordCount(); id++)
+        ids.push_back(id);
+    // Ties on time go to the other end of the flight, then to the id, so the
+    // bucket order does not depend on the sort algorithm.
+    airport_from_bucket_index = CompactFlightGraphNodeContainer<Key>(
+        airport_range, {ids.data(), ids.size()},
+        [this](Key id) { return columns.airport_from[id - 1]; },
+        [this](Key id) { return columns.datetime_from[id - 1]; },
+        [this](Key a, Key b) {
+            return std::tuple(columns.datetime_from[a - 1], columns.airport_to[a - 1], a) <
+                   std::tuple(columns.datetime_from[b - 1], columns.airport_to[b - 1], b);
+        });
+    airport_to_bucket_index = CompactFlightGraphNodeContainer<Key>(
+        airport_range, {ids.data(), ids.size()},
+        [this](Key id) { return columns.airport_to[id - 1]; },
+        [this](Key id) { return columns.datetime_to[id - 1]; },
+        [this](Key a, Key b) {
+            return std::tuple(columns.datetime_to[a - 1], columns.airport_from[a - 1], a) <
+                   std::tuple(columns.datetime_to[b - 1], columns.airport_from[b - 1], b);
+        });
+}
+
+void FlightDatabase::InitRouteIndex() {
+    route_index_storage = std::make_shared<RouteIndexStorage>();
+    auto& storage = *route_index_storage;
+    auto size = RecordCount();
+    auto by_route = [this](auto& datetime) {
+        return [this, &datetime](Key a, Key b) {
+            auto route_a = std::tuple(columns.airport_from[a - 1], columns.airport_to[a - 1], datetime[a - 1], a);
+            auto route_b = std::tuple(columns.airport_from[b - 1], columns.airport_to[b - 1], datetime[b - 1], b);
+            return route_a < route_b;
+        };
+    };
+    storage.ids_by_departure.reserve(size);
+    for (Key id = 1; size_t(id) <= size; id++)
+        storage.ids_by_departure.push_back(id);
+    std::sort(storage.ids_by_departure.begin(), storage.ids_by_departure.end(), by_route(columns.datetime_from));
+    storage.ids_by_arrival.reserve(size);
+    for (auto id : storage.ids_by_departure)
+        storage.ids_by_arrival.push_back(id);
+    std::sort(storage.ids_by_arrival.begin(), storage.ids_by_arrival.end(), by_route(columns.datetime_to));
+
+    // Both orders group the flights by route identically, so one pass over
+    // either finds the route boundaries.
+    auto airports = airport_range.max - airport_range.min + 1;
+    storage.origins.reserve(airports + 1);
+    storage.origins.push_back(0);
+    storage.departures.reserve(size);
+    storage.arrivals.reserve(size);
+    for (size_t i = 0; i < size; i++) {
+        auto id = storage.ids_by_departure[i];
+        auto from = columns.airport_from[id - 1], to = columns.airport_to[id - 1];
+        if (i == 0 || from != columns.airport_from[storage.ids_by_departure[i - 1] - 1] ||
+            to != columns.airport_to[storage.ids_by_departure[i - 1] - 1]) {
+            while (storage.origins.size() <= size_t(from - airport_range.min))
+                storage.origins.push_back(storage.destinations.size());
+            storage.destinations.push_back(to);
+            storage.offsets.push_back(i);
+        }
+        storage.departures.push_back(columns.datetime_from[id - 1]);
+        storage.arrivals.push_back(columns.datetime_to[storage.ids_by_arrival[i] - 1]);
     }
-    airport_from_bucket_index->Sort([this](Key a, Key b) {
-        auto& record_a = records[a - 1];
-        auto& record_b = records[b - 1];
-        return record_a.datetime_from < record_b.datetime_from ||
-               (record_a.datetime_from == record_b.datetime_from &&
-                record_a.airport_to < record_b.airport_to);
-    });
-    airport_to_bucket_index->Sort([this](Key a, Key b) {
-        auto& record_a = records[a - 1];
-        auto& record_b = records[b - 1];
-        return record_a.datetime_to < record_b.datetime_to ||
-               (record_a.datetime_to == record_b.datetime_to &&
-                record_a.airport_from < record_b.airport_from);
-    });
+    while (storage.origins.size() <= size_t(airports))
+        storage.origins.push_back(storage.destinations.size());
+    storage.offsets.push_back(size);
+
+    route_index.origins = {storage.origins.data(), storage.origins.size()};
+    route_index.destinations = {storage.destinations.data(), storage.destinations.size()};
+    route_index.offsets = {storage.offsets.data(), storage.offsets.size()};
+    route_index.ids_by_departure = {storage.ids_by_departure.data(), size};
+    route_index.ids_by_arrival = {storage.ids_by_arrival.data(), size};
+    route_index.departures = {storage.departures.data(), size};
+    route_index.arrivals = {storage.arrivals.data(), size};
+}
+
+long FlightDatabase::FindRoute(Airport airport_from, Airport airport_to) const {
+    airport_range.WithinOrThrow(airport_from);
+    auto index = airport_from - airport_range.min;
+    auto begin = route_index.destinations.begin() + route_index.origins[index];
+    auto end = route_index.destinations.begin() + route_index.origins[index + 1];
+    auto route = std::lower_bound(begin, end, airport_to);
+    if (route == end || *route != airport_to)
+        return -1;
+    return route - route_index.destinations.begin();
+}
+
+FlightDatabase::Bucket FlightDatabase::RouteDepartures(Airport airport_from, Airport airport_to) const {
+    auto route = FindRoute(airport_from, airport_to);
+    if (route < 0)
+        return {};
+    auto begin = route_index.offsets[route], size = route_index.offsets[route + 1] - begin;
+    return {route_index.ids_by_departure.subspan(begin, size), route_index.departures.subspan(begin, size)};
+}
+
+FlightDatabase::Bucket FlightDatabase::RouteArrivals(Airport airport_from, Airport airport_to) const {
+    auto route = FindRoute(airport_from, airport_to);
+    if (route < 0)
+        return {};
+    auto begin = route_index.offsets[route], size = route_index.offsets[route + 1] - begin;
+    return {route_index.ids_by_arrival.subspan(begin, size), route_index.arrivals.subspan(begin, size)};
 }
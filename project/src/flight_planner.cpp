@@ -1,90 +1,109 @@
 #include "../include/flight_planner.hpp"
-#include "../include/flight_graph_complete.hpp"
-#include "../include/flight_graph_complete_with_price.hpp"
-#include "../include/flight_graph_complete_with_time.hpp"
 
-static void SyncAirportStatus(std::shared_ptr<AbstractFlightGraph> graph, std::shared_ptr<FlightDatabase> db) {
-    graph->OnNodeDiscovered.AddListener([&](auto node) {
-        auto result = db->QueryRecordIdsByAirportTo(node->Key().airport);
-        for (auto id : *result) {
-            auto record = db->QueryRecordById(id);
-            auto node = graph->GetNode({record.airport_to, record.datetime_to});
-            if (node->GetStatus() == AbstractFlightGraph::Node::Status::UNDISCOVERED)
-                node->Discover(false);
-        }
-    });
-    graph->OnNodeVisited.AddListener([&](auto node) {
-        auto result = db->QueryRecordIdsByAirportTo(node->Key().airport);
-        for (auto id : *result) {
-            auto record = db->QueryRecordById(id);
-            auto node = graph->GetNode({record.airport_to, record.datetime_to});
-            if (node->GetStatus() == AbstractFlightGraph::Node::Status::DISCOVERED)
-                node->Visit(false);
-        }
-    });
+// Lists airports in the order they are discovered. Discovering or visiting a
+// node does the same to every arrival node of its airport, which turns the
+// node-level search into an airport-level one.
+struct AirportVisitor : FlatFlightGraph::Visitor {
+    FlatFlightGraph& search;
+    std::shared_ptr<List<Airport>> result = std::make_shared<List<Airport>>();
+
+    AirportVisitor(FlatFlightGraph& search)
+        : search(search) {}
+    FlatFlightGraph::Control Discover(FlatFlightGraph::NodeId node) {
+        auto airport = search.Key(node).airport;
+        auto [first, last] = search.Graph().NodesOf(airport);
+        for (auto node = first; node < last; node++)
+            if (search.GetStatus(node) == FlatFlightGraph::Status::UNDISCOVERED)
+                search.Discover(node, false);
+        result->push_back(airport);
+        return FlatFlightGraph::Control::CONTINUE;
+    }
+    FlatFlightGraph::Control Visit(FlatFlightGraph::NodeId node) {
+        auto [first, last] = search.Graph().NodesOf(search.Key(node).airport);
+        for (auto node = first; node < last; node++)
+            if (search.GetStatus(node) == FlatFlightGraph::Status::DISCOVERED)
+                search.Visit(node, false);
+        return FlatFlightGraph::Control::CONTINUE;
+    }
+};
+
+std::shared_ptr<const Raptor> Planner::Trips() const {
+    std::call_once(raptor_built, [this] { raptor = std::make_shared<Raptor>(*db); });
+    return raptor;
 }
 
 std::shared_ptr<List<Airport>> Planner::EnumerateAirportsDFS(Airport airport, DateTime datetime_from) {
-    auto graph = std::make_shared<FlightGraphComplete>(db);
-    auto result = std::make_shared<List<Airport>>();
-    SyncAirportStatus(graph, db);
-    graph->OnNodeDiscovered.AddListener([&](auto node) {
-        result->push_back(node->Key().airport);
-    });
-    auto node = graph->GetNode({airport, datetime_from});
-    node->DFS();
-    return result;
+    auto search = FlatFlightGraph(graph);
+    auto visitor = AirportVisitor(search);
+    search.DFS(search.GetNode({airport, datetime_from}), visitor);
+    return visitor.result;
 }
 
 std::shared_ptr<List<Airport>> Planner::EnumerateAirportsBFS(Airport airport, DateTime datetime_from) {
-    auto graph = std::make_shared<FlightGraphComplete>(db);
-    auto result = std::make_shared<List<Airport>>();
-    SyncAirportStatus(graph, db);
-    graph->OnNodeDiscovered.AddListener([&](auto node) {
-        result->push_back(node->Key().airport);
-    });
-    auto node = graph->GetNode({airport, datetime_from});
-    node->BFS();
-    return result;
+    auto search = FlatFlightGraph(graph);
+    auto visitor = AirportVisitor(search);
+    search.BFS(search.GetNode({airport, datetime_from}), visitor);
+    return visitor.result;
 }
 
 Planner::PathList Planner::EnumerateAllPaths(int airport_from, int airport_to, DateTime datetime_from, DateTime datetime_to, int depth_limit) {
-    auto graph = std::make_shared<FlightGraphComplete>(db);
-    auto from = graph->GetNode({airport_from, datetime_from});
-    auto to = graph->GetNode({airport_to, datetime_to});
-    auto paths = graph->AllPathsTo(from, to, depth_limit);
-    return ConvertPathList(paths);
+    auto search = FlatFlightGraph(graph);
+    auto from = search.GetNode({airport_from, datetime_from});
+    auto to = search.GetNode({airport_to, datetime_to});
+    auto paths = search.AllPathsTo(from, to, depth_limit);
+    return ConvertPathList(search, paths);
 }
 
 std::optional<Planner::Path> Planner::QueryMinimumTimePath(int airport_from, int airport_to, DateTime datetime_from, DateTime datetime_to) {
-    auto graph = std::make_shared<FlightGraphCompleteWithTime>(db);
-    auto from = graph->GetNode({airport_from, datetime_from});
-    auto to = graph->GetNode({airport_to, datetime_to});
-    auto path = graph->BestPathTo(from, to);
-    return path.has_value() ? std::make_optional(ConvertPath(path.value())) : std::nullopt;
+    auto journey = connections->EarliestArrival(airport_from, airport_to, datetime_from, datetime_to);
+    return journey.has_value() ? std::make_optional(ConvertJourney(journey.value())) : std::nullopt;
 }
 
 std::optional<Planner::Path> Planner::QueryMinimumCostPath(int airport_from, int airport_to, DateTime datetime_from, DateTime datetime_to) {
-    auto graph = std::make_shared<FlightGraphCompleteWithPrice>(db);
-    auto from = graph->GetNode({airport_from, datetime_from});
-    auto to = graph->GetNode({airport_to, datetime_to});
-    auto path = graph->BestPathTo(from, to);
-    return path.has_value() ? std::make_optional(ConvertPath(path.value())) : std::nullopt;
+    auto search = FlatFlightGraph(graph, FlatFlightGraph::Weight::PRICE);
+    auto from = search.GetNode({airport_from, datetime_from});
+    auto to = search.GetNode({airport_to, datetime_to});
+    auto path = search.ShortestPathTo(from, to, *bounds->To(airport_to));
+    return path.has_value() ? std::make_optional(ConvertPath(search, path.value())) : std::nullopt;
+}
+
+ConnectionScan::Profile Planner::QueryArrivalProfile(int airport_from, int airport_to, DateTime datetime_from, DateTime datetime_to) {
+    return connections->ArrivalProfile(airport_from, airport_to, datetime_from, datetime_to);
+}
+
+Planner::PathList Planner::QueryParetoPaths(int airport_from, int airport_to, DateTime datetime_from, DateTime datetime_to) {
+    auto journeys = connections->ParetoJourneys(airport_from, airport_to, datetime_from, datetime_to, bounds->To(airport_to).get());
+    auto result = std::make_shared<List<Path>>();
+    for (auto journey : *journeys)
+        result->push_back(ConvertJourney(journey));
+    return result;
+}
+
+std::optional<Planner::Path> Planner::QueryFewestTransfersPath(int airport_from, int airport_to, DateTime datetime_from, DateTime datetime_to) {
+    auto journey = Trips()->FewestTransfers(airport_from, airport_to, datetime_from, datetime_to);
+    return journey.has_value() ? std::make_optional(ConvertJourney(journey.value())) : std::nullopt;
+}
+
+Planner::Path Planner::ConvertJourney(ConnectionScan::Journey journey) {
+    auto result = std::make_shared<Vector<FlightDatabase::Record>>();
+    for (auto id : *journey)
+        result->push_back(db->QueryRecordById(id));
+    return result;
 }
 
-Planner::Path Planner::ConvertPath(AbstractFlightGraph::Path path) {
+Planner::Path Planner::ConvertPath(const FlatFlightGraph& search, FlatFlightGraph::Path path) {
     auto result = std::make_shared<Vector<FlightDatabase::Record>>();
     for (auto to = path->begin(), from = to++; to != path->end(); from = to++) {
         auto record = db->QueryRecordByAirportsAndArrivalTime(
-            (*from)->Key().airport, (*to)->Key().airport, (*to)->Key().no_sooner_than);
+            search.Key(*from).airport, search.Key(*to).airport, search.Key(*to).no_sooner_than);
         result->push_back(record);
     }
     return result;
 }
 
-Planner::PathList Planner::ConvertPathList(AbstractFlightGraph::PathList path_list) {
+Planner::PathList Planner::ConvertPathList(const FlatFlightGraph& search, FlatFlightGraph::PathList path_list) {
     auto result = std::make_shared<List<Path>>();
     for (auto path : *path_list)
-        result->push_back(ConvertPath(path));
+        result->push_back(ConvertPath(search, path));
     return result;
 }
@@ -0,0 +1,225 @@
+#include "../include/flight_snapshot.hpp"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include "../include/flight_database.hpp"
+
+namespace {
+
+struct PendingSection {
+    SnapshotSectionId id;
+    uint32_t element_size;
+    const void* data;
+    uint64_t count;
+};
+
+// Streams the body of a snapshot to disk, padding every piece to 8 bytes and
+// keeping the checksum up to date.
+class SnapshotWriter {
+   private:
+    std::ofstream file;
+    SnapshotChecksum checksum;
+    uint64_t offset = 0;
+
+   public:
+    SnapshotWriter(std::string filename)
+        : file(filename, std::ios::binary | std::ios::trunc) {
+        if (!file.is_open())
+            throw std::runtime_error("Failed to open file: " + filename);
+    }
+
+    uint64_t Offset() const { return offset; }
+    uint64_t Checksum() const { return checksum.Value(); }
+
+    void Write(const void* data, size_t size, bool checksummed = true) {
+        static const char zeros[8] = {};
+        auto padding = (8 - size % 8) % 8;
+        file.write(static_cast<const char*>(data), size);
+        file.write(zeros, padding);
+        if (checksummed) {
+            checksum.Update(data, size - size % 8);
+            if (size % 8 != 0) {
+                char tail[8] = {};
+                std::memcpy(tail, static_cast<const char*>(data) + size - size % 8, size % 8);
+                checksum.Update(tail, 8);
+            }
+        }
+        offset += size + padding;
+    }
+
+    void Rewrite(uint64_t position, const void* data, size_t size) {
+        file.seekp(position);
+        file.write(static_cast<const char*>(data), size);
+        file.seekp(offset);
+    }
+
+    void Close() {
+        file.close();
+        if (file.fail())
+            throw std::runtime_error("Failed to write snapshot");
+    }
+};
+
+SnapshotHeader ReadHeader(const MappedFile& file) {
+    auto header = SnapshotHeader();
+    if (file.Size() < sizeof(header))
+        throw std::runtime_error("Snapshot is truncated");
+    std::memcpy(&header, file.Data(), sizeof(header));
+    if (std::memcmp(header.magic, SnapshotHeader::kMagic, sizeof(header.magic)) != 0)
+        throw std::runtime_error("Not a flight database snapshot");
+    if (header.version != SnapshotHeader::kVersion)
+        throw std::runtime_error("Unsupported snapshot version " + std::to_string(header.version));
+    if (header.file_size != file.Size())
+        throw std::runtime_error("Snapshot is truncated");
+    if (sizeof(header) + header.section_count * sizeof(SnapshotSection) > file.Size())
+        throw std::runtime_error("Snapshot section table is truncated");
+    return header;
+}
+
+template <typename T>
+std::span<const T> SectionOf(const MappedFile& file, const SnapshotHeader& header, SnapshotSectionId id) {
+    auto table = reinterpret_cast<const SnapshotSection*>(file.Data() + sizeof(header));
+    for (uint32_t i = 0; i < header.section_count; i++) {
+        auto& section = table[i];
+        if (section.id != id)
+            continue;
+        if (section.element_size != sizeof(T) || section.offset % 8 != 0 ||
+            section.offset > file.Size() || section.count > (file.Size() - section.offset) / sizeof(T))
+            throw std::runtime_error("Malformed snapshot section " + std::to_string(uint32_t(id)));
+        return {reinterpret_cast<const T*>(file.Data() + section.offset), section.count};
+    }
+    throw std::runtime_error("Missing snapshot section " + std::to_string(uint32_t(id)));
+}
+
+}  // namespace
+
+void FlightDatabase::SaveSnapshot(std::string filename) const {
+    auto section = [](SnapshotSectionId id, auto span) {
+        return PendingSection{id, sizeof(span[0]), span.data(), span.size()};
+    };
+    PendingSection sections[] = {
+        section(SnapshotSectionId::AIRPORT_FROM, columns.airport_from),
+        section(SnapshotSectionId::AIRPORT_TO, columns.airport_to),
+        section(SnapshotSectionId::DATETIME_FROM, columns.datetime_from),
+        section(SnapshotSectionId::DATETIME_TO, columns.datetime_to),
+        section(SnapshotSectionId::PRICE, columns.price),
+        section(SnapshotSectionId::FLIGHT_NUMBER, columns.flight_number),
+        section(SnapshotSectionId::FROM_OFFSETS, airport_from_bucket_index.Offsets()),
+        section(SnapshotSectionId::FROM_IDS, airport_from_bucket_index.Elements()),
+        section(SnapshotSectionId::FROM_DATETIMES, airport_from_bucket_index.DateTimes()),
+        section(SnapshotSectionId::TO_OFFSETS, airport_to_bucket_index.Offsets()),
+        section(SnapshotSectionId::TO_IDS, airport_to_bucket_index.Elements()),
+        section(SnapshotSectionId::TO_DATETIMES, airport_to_bucket_index.DateTimes()),
+        section(SnapshotSectionId::ROUTE_ORIGINS, route_index.origins),
+        section(SnapshotSectionId::ROUTE_DESTINATIONS, route_index.destinations),
+        section(SnapshotSectionId::ROUTE_OFFSETS, route_index.offsets),
+        section(SnapshotSectionId::ROUTE_IDS_BY_DEPARTURE, route_index.ids_by_departure),
+        section(SnapshotSectionId::ROUTE_IDS_BY_ARRIVAL, route_index.ids_by_arrival),
+        section(SnapshotSectionId::ROUTE_DEPARTURES, route_index.departures),
+        section(SnapshotSectionId::ROUTE_ARRIVALS, route_index.arrivals),
+    };
+    auto section_count = uint32_t(std::size(sections));
+
+    auto header = SnapshotHeader();
+    std::memcpy(header.magic, SnapshotHeader::kMagic, sizeof(header.magic));
+    header.version = SnapshotHeader::kVersion;
+    header.section_count = section_count;
+    header.record_count = RecordCount();
+    header.airport_min = airport_range.min;
+    header.airport_max = airport_range.max;
+
+    auto table = Vector<SnapshotSection>();
+    auto position = uint64_t(sizeof(SnapshotHeader) + section_count * sizeof(SnapshotSection));
+    for (auto& section : sections) {
+        table.push_back({section.id, section.element_size, position, section.count});
+        position += (section.element_size * section.count + 7) / 8 * 8;
+    }
+    header.file_size = position;
+
+    // Write to a temporary file first, so that readers never map a half-written snapshot.
+    auto temporary = filename + ".tmp";
+    auto writer = SnapshotWriter(temporary);
+    writer.Write(&header, sizeof(header), false);
+    writer.Write(table.data(), table.size() * sizeof(SnapshotSection));
+    for (auto& section : sections)
+        writer.Write(section.data, section.element_size * section.count);
+    header.checksum = writer.Checksum();
+    writer.Rewrite(0, &header, sizeof(header));
+    writer.Close();
+    std::filesystem::rename(temporary, filename);
+}
+
+void FlightDatabase::LoadSnapshot(std::string filename) {
+    snapshot = std::make_shared<MappedFile>(filename);
+    auto header = ReadHeader(*snapshot);
+    airport_range = {header.airport_min, header.airport_max};
+    if (airport_range.min > airport_range.max)
+        throw std::runtime_error("Malformed snapshot airport range");
+    columns.airport_from = SectionOf<CompactAirport>(*snapshot, header, SnapshotSectionId::AIRPORT_FROM);
+    columns.airport_to = SectionOf<CompactAirport>(*snapshot, header, SnapshotSectionId::AIRPORT_TO);
+    columns.datetime_from = SectionOf<DateTime>(*snapshot, header, SnapshotSectionId::DATETIME_FROM);
+    columns.datetime_to = SectionOf<DateTime>(*snapshot, header, SnapshotSectionId::DATETIME_TO);
+    columns.price = SectionOf<Price>(*snapshot, header, SnapshotSectionId::PRICE);
+    columns.flight_number = SectionOf<FlightNumber>(*snapshot, header, SnapshotSectionId::FLIGHT_NUMBER);
+    // The indexes and the queries index arrays by these, so a corrupt file
+    // must fail here rather than read out of bounds later.
+    auto valid_ids = [&](std::span<const Key> ids) {
+        return std::all_of(ids.begin(), ids.end(), [&](Key id) { return id >= 1 && uint64_t(id) <= header.record_count; });
+    };
+    auto valid_airports = [&](std::span<const CompactAirport> airports) {
+        return std::all_of(airports.begin(), airports.end(), [&](CompactAirport airport) {
+            return airport >= airport_range.min && airport <= airport_range.max;
+        });
+    };
+    auto load_index = [&](SnapshotSectionId offsets, SnapshotSectionId ids, SnapshotSectionId datetimes) {
+        auto index = CompactFlightGraphNodeContainer<Key>(
+            airport_range,
+            SectionOf<uint32_t>(*snapshot, header, offsets),
+            SectionOf<Key>(*snapshot, header, ids),
+            SectionOf<DateTime>(*snapshot, header, datetimes));
+        if (index.Elements().size() != header.record_count || !valid_ids(index.Elements()))
+            throw std::runtime_error("Malformed snapshot index");
+        return index;
+    };
+    for (auto size : {columns.airport_from.size(), columns.airport_to.size(), columns.datetime_from.size(),
+                      columns.datetime_to.size(), columns.price.size(), columns.flight_number.size()})
+        if (size != header.record_count)
+            throw std::runtime_error("Malformed snapshot columns");
+    if (!valid_airports(columns.airport_from) || !valid_airports(columns.airport_to))
+        throw std::runtime_error("Malformed snapshot columns");
+    airport_from_bucket_index = load_index(
+        SnapshotSectionId::FROM_OFFSETS, SnapshotSectionId::FROM_IDS, SnapshotSectionId::FROM_DATETIMES);
+    airport_to_bucket_index = load_index(
+        SnapshotSectionId::TO_OFFSETS, SnapshotSectionId::TO_IDS, SnapshotSectionId::TO_DATETIMES);
+    route_index.origins = SectionOf<uint32_t>(*snapshot, header, SnapshotSectionId::ROUTE_ORIGINS);
+    route_index.destinations = SectionOf<CompactAirport>(*snapshot, header, SnapshotSectionId::ROUTE_DESTINATIONS);
+    route_index.offsets = SectionOf<uint32_t>(*snapshot, header, SnapshotSectionId::ROUTE_OFFSETS);
+    route_index.ids_by_departure = SectionOf<Key>(*snapshot, header, SnapshotSectionId::ROUTE_IDS_BY_DEPARTURE);
+    route_index.ids_by_arrival = SectionOf<Key>(*snapshot, header, SnapshotSectionId::ROUTE_IDS_BY_ARRIVAL);
+    route_index.departures = SectionOf<DateTime>(*snapshot, header, SnapshotSectionId::ROUTE_DEPARTURES);
+    route_index.arrivals = SectionOf<DateTime>(*snapshot, header, SnapshotSectionId::ROUTE_ARRIVALS);
+    auto routes = route_index.destinations.size();
+    for (auto size : {route_index.ids_by_departure.size(), route_index.ids_by_arrival.size(),
+                      route_index.departures.size(), route_index.arrivals.size()})
+        if (size != header.record_count)
+            throw std::runtime_error("Malformed snapshot route index");
+    if (route_index.origins.size() != size_t(airport_range.max - airport_range.min) + 2 ||
+        route_index.origins.front() != 0 || route_index.origins.back() != routes ||
+        route_index.offsets.size() != routes + 1 || route_index.offsets.front() != 0 ||
+        route_index.offsets.back() != header.record_count)
+        throw std::runtime_error("Malformed snapshot route index");
+    if (!std::is_sorted(route_index.origins.begin(), route_index.origins.end()) ||
+        !std::is_sorted(route_index.offsets.begin(), route_index.offsets.end()) ||
+        !valid_airports(route_index.destinations) || !valid_ids(route_index.ids_by_departure) ||
+        !valid_ids(route_index.ids_by_arrival))
+        throw std::runtime_error("Malformed snapshot route index");
+}
+
+void FlightDatabase::VerifySnapshot(std::string filename) {
+    auto file = MappedFile(filename);
+    auto header = ReadHeader(file);
+    auto checksum = SnapshotChecksum();
+    checksum.Update(file.Data() + sizeof(header), file.Size() - sizeof(header));
+    if (checksum.Value() != header.checksum)
+        throw std::runtime_error("Snapshot checksum mismatch: " + filename);
+}
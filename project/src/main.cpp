@@ -3,8 +3,8 @@
 #include <string>
 #include "../include/flight_planner.hpp"
 
-auto db = std::make_shared<FlightDatabase>("../project/data/flight-data.csv");
-auto planner = std::make_shared<Planner>(db);
+std::shared_ptr<FlightDatabase> db;
+std::shared_ptr<Planner> planner;
 
 static std::string ReadToken(std::string& query) {
     auto token = query.substr(0, query.find(' '));
@@ -23,15 +23,9 @@ static DateTime ReadDateTime(std::string& query) {
 }
 
 static std::string DateTimeToString(DateTime datetime) {
-    auto date = datetime / 10000;
-    auto time = datetime % 10000;
-    auto year = date / 10000;
-    auto month = (date / 100) % 100;
-    auto day = date % 100;
-    auto hour = time / 100;
-    auto minute = time % 100;
-    return std::to_string(year) + "/" + std::to_string(month) + "/" + std::to_string(day) + " " +
-           std::to_string(hour) + ":" + std::to_string(minute);
+    auto civil = CivilFromDateTime(datetime);
+    return std::to_string(civil.year) + "/" + std::to_string(civil.month) + "/" + std::to_string(civil.day) + " " +
+           std::to_string(civil.hour) + ":" + std::to_string(civil.minute);
 }
 
 static void PrintPath(Planner::Path path) {
@@ -45,7 +39,13 @@ static void PrintPath(Planner::Path path) {
     printf("\n");
 }
 
-int main() {
+int main(int argc, char** argv) {
+    // A .fdb snapshot (see fdb_convert) is mapped instead of parsed.
+    auto filename = std::string(argc > 1 ? argv[1] : "../project/data/flight-data.csv");
+    auto mode = filename.ends_with(".fdb") ? FlightDatabase::LoadMode::SNAPSHOT : FlightDatabase::LoadMode::MAPPED;
+    db = std::make_shared<FlightDatabase>(filename, mode);
+    planner = std::make_shared<Planner>(db);
+
     while (!std::cin.eof()) {
         try {
             printf("> ");
@@ -106,6 +106,48 @@ int main() {
                     PrintPath(result.value());
                 else
                     printf("No path found\n");
+            } else if (operation == "fewest_transfers") {
+                auto airport_from = ReadInt(query);
+                auto airport_to = ReadInt(query);
+                auto datetime_from = ReadDateTime(query);
+                auto datetime_to = ReadDateTime(query);
+                auto result = planner->QueryFewestTransfersPath(airport_from, airport_to, datetime_from, datetime_to);
+                if (result.has_value())
+                    PrintPath(result.value());
+                else
+                    printf("No path found\n");
+            } else if (operation == "profile") {
+                auto airport_from = ReadInt(query);
+                auto airport_to = ReadInt(query);
+                auto datetime_from = ReadDateTime(query);
+                auto datetime_to = ReadDateTime(query);
+                auto result = planner->QueryArrivalProfile(airport_from, airport_to, datetime_from, datetime_to);
+                for (auto& entry : *result) {
+                    auto departure = DateTimeToString(entry.departure);
+                    auto arrival = DateTimeToString(entry.arrival);
+                    printf("%s => %s\n", departure.c_str(), arrival.c_str());
+                }
+                if (result->empty())
+                    printf("No path found\n");
+            } else if (operation == "pareto") {
+                auto airport_from = ReadInt(query);
+                auto airport_to = ReadInt(query);
+                auto datetime_from = ReadDateTime(query);
+                auto datetime_to = ReadDateTime(query);
+                auto result = planner->QueryParetoPaths(airport_from, airport_to, datetime_from, datetime_to);
+                for (auto path : *result) {
+                    auto price = 0;
+                    for (auto& record : *path)
+                        price += record.price;
+                    auto arrival = DateTimeToString(path->empty() ? datetime_from : path->at(path->size() - 1).datetime_to);
+                    printf("%s $%d %zu flights: ", arrival.c_str(), price, path->size());
+                    if (!path->empty())
+                        PrintPath(path);
+                    else
+                        printf("\n");
+                }
+                if (result->empty())
+                    printf("No path found\n");
             } else {
                 if (!operation.empty())
                     printf("Unknown operation: %s\n", operation.c_str());
@@ -0,0 +1,56 @@
+#include "../include/mapped_file.hpp"
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <fstream>
+#include <iterator>
+
+MappedFile::MappedFile(std::string filename) {
+    auto file = std::ifstream(filename, std::ios::binary);
+    if (!file.is_open())
+        throw std::runtime_error("Failed to open file: " + filename);
+    file.seekg(0, std::ios::end);
+    size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    auto buffer = new char[size];
+    file.read(buffer, size);
+    data = buffer;
+}
+
+MappedFile::~MappedFile() {
+    delete[] data;
+}
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(std::string filename) {
+    auto fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("Failed to open file: " + filename);
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close(fd);
+        throw std::runtime_error("Failed to stat file: " + filename);
+    }
+    size = info.st_size;
+    if (size > 0) {
+        auto address = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (address == MAP_FAILED) {
+            close(fd);
+            throw std::runtime_error("Failed to map file: " + filename);
+        }
+        madvise(address, size, MADV_SEQUENTIAL);
+        data = static_cast<const char*>(address);
+        mapped = true;
+    }
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (mapped)
+        munmap(const_cast<char*>(data), size);
+}
+#endif
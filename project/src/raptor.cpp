@@ -0,0 +1,232 @@
+#include "../include/raptor.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+Raptor::Raptor(const FlightDatabase& flight_database)
+    : airport_range(flight_database.AirportRange()) {
+    auto number = flight_database.FlightNumberColumn();
+    auto airport_from = flight_database.AirportFromColumn();
+    auto airport_to = flight_database.AirportToColumn();
+    auto datetime_from = flight_database.DateTimeFromColumn();
+    auto datetime_to = flight_database.DateTimeToColumn();
+
+    // Flights by number, then departure; a trip is a run of them that connect.
+    auto order = std::vector<uint32_t>(flight_database.RecordCount());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return std::tie(number[a], datetime_from[a], a) < std::tie(number[b], datetime_from[b], b);
+    });
+    auto trips = std::vector<std::vector<uint32_t>>();
+    for (auto flight : order) {
+        if (!trips.empty()) {
+            auto last = trips.back().back();
+            if (number[last] == number[flight] && airport_to[last] == airport_from[flight] &&
+                datetime_to[last] <= datetime_from[flight]) {
+                trips.back().push_back(flight);
+                continue;
+            }
+        }
+        trips.push_back({flight});
+    }
+
+    // Trips by the airports they call at, in order of departure from the first.
+    auto stops_of = [&](const std::vector<uint32_t>& trip) {
+        auto stops = std::vector<CompactAirport>{airport_from[trip[0]]};
+        for (auto flight : trip)
+            stops.push_back(airport_to[flight]);
+        return stops;
+    };
+    auto by_stops = std::map<std::vector<CompactAirport>, std::vector<uint32_t>>();
+    for (uint32_t trip = 0; trip < trips.size(); trip++)
+        by_stops[stops_of(trips[trip])].push_back(trip);
+    // The times of a trip at a stop; it leaves the last stop when it lands
+    // and lands at the first when it leaves, which keeps both columns sorted.
+    auto arrival_at = [&](uint32_t trip, size_t stop) {
+        return stop == 0 ? datetime_from[trips[trip][0]] : datetime_to[trips[trip][stop - 1]];
+    };
+    auto departure_at = [&](uint32_t trip, size_t stop) {
+        return stop == trips[trip].size() ? datetime_to[trips[trip][stop - 1]] : datetime_from[trips[trip][stop]];
+    };
+
+    for (auto& [stops, group] : by_stops) {
+        std::sort(group.begin(), group.end(), [&](uint32_t a, uint32_t b) {
+            return std::tie(datetime_from[trips[a][0]], trips[a][0]) < std::tie(datetime_from[trips[b][0]], trips[b][0]);
+        });
+        // A trip joins the first route whose last trip it does not overtake.
+        auto split = std::vector<std::vector<uint32_t>>();
+        for (auto trip : group) {
+            auto route = std::find_if(split.begin(), split.end(), [&](const std::vector<uint32_t>& route) {
+                for (size_t stop = 0; stop < stops.size(); stop++)
+                    if (arrival_at(route.back(), stop) > arrival_at(trip, stop) ||
+                        departure_at(route.back(), stop) > departure_at(trip, stop))
+                        return false;
+                return true;
+            });
+            if (route == split.end())
+                split.push_back({trip});
+            else
+                route->push_back(trip);
+        }
+        for (auto& members : split) {
+            auto trip_count = uint32_t(members.size());
+            auto route = Route{uint32_t(route_stops.size()), uint32_t(stops.size()),
+                               uint32_t(arrivals.size()), uint32_t(flights.size()), trip_count};
+            for (auto stop : stops)
+                route_stops.push_back(stop);
+            for (size_t stop = 0; stop < stops.size(); stop++)
+                for (auto trip : members) {
+                    arrivals.push_back(arrival_at(trip, stop));
+                    departures.push_back(departure_at(trip, stop));
+                }
+            for (size_t stop = 0; stop + 1 < stops.size(); stop++)
+                for (auto trip : members)
+                    flights.push_back(::Key(trips[trip][stop] + 1));
+            routes.push_back(route);
+        }
+    }
+
+    // Every stop but the last of a route boards it.
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    airport_offsets.resize(airports + 1, 0);
+    for (auto& route : routes)
+        for (uint32_t stop = 0; stop + 1 < route.stop_count; stop++)
+            airport_offsets[route_stops[route.first_stop + stop] - airport_range.min + 1]++;
+    for (size_t i = 0; i < airports; i++)
+        airport_offsets[i + 1] += airport_offsets[i];
+    airport_routes.resize(airport_offsets[airports]);
+    auto next = std::vector<uint32_t>(airport_offsets.begin(), airport_offsets.end() - 1);
+    for (uint32_t index = 0; index < routes.size(); index++) {
+        auto& route = routes[index];
+        for (uint32_t stop = 0; stop + 1 < route.stop_count; stop++)
+            airport_routes[next[route_stops[route.first_stop + stop] - airport_range.min]++] = {index, stop};
+    }
+}
+
+size_t Raptor::TripCount() const {
+    auto count = size_t(0);
+    for (auto& route : routes)
+        count += route.trip_count;
+    return count;
+}
+
+Raptor::JourneyList Raptor::Journeys(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to,
+                                     int max_rides) const {
+    return Run(airport_from, airport_to, datetime_from, datetime_to, max_rides, false);
+}
+
+std::optional<Raptor::Journey> Raptor::FewestTransfers(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to) const {
+    auto journeys = Run(airport_from, airport_to, datetime_from, datetime_to, INT_MAX, true);
+    return journeys->empty() ? std::nullopt : std::make_optional(journeys->front());
+}
+
+Raptor::JourneyList Raptor::Run(Airport airport_from, Airport airport_to, DateTime datetime_from, DateTime datetime_to,
+                                int max_rides, bool first_only) const {
+    airport_range.WithinOrThrow(airport_from);
+    airport_range.WithinOrThrow(airport_to);
+    if (max_rides < 0)
+        throw std::invalid_argument("Negative number of rides: " + std::to_string(max_rides));
+    auto result = std::make_shared<List<Journey>>();
+    if (datetime_from > datetime_to)
+        return result;
+    if (airport_from == airport_to) {
+        result->push_back(std::make_shared<List<::Key>>());
+        return result;
+    }
+
+    // How an airport was reached in a round: the ride of `trip` on `route`
+    // from stop `board` to stop `alight`. Set only if the round improved it.
+    constexpr auto kNone = UINT32_MAX;
+    struct Label {
+        DateTime arrival;
+        uint32_t route, trip, board, alight;
+    };
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    auto from = airport_from - airport_range.min, to = airport_to - airport_range.min;
+    auto unreached = Label{kDateTimeMax, kNone, kNone, kNone, kNone};
+    auto rounds = std::vector<std::vector<Label>>(1, std::vector<Label>(airports, unreached));
+    rounds[0][from].arrival = datetime_from;
+    // The earliest arrival with any number of rides so far; at the start of
+    // round k, the earliest with at most k - 1.
+    auto earliest = std::vector<DateTime>(airports, kDateTimeMax);
+    earliest[from] = datetime_from;
+    auto previous = earliest;
+    auto marked = std::vector<uint32_t>{uint32_t(from)};
+    auto is_marked = std::vector<bool>(airports, false);
+    // The first marked stop of every route to scan in this round.
+    auto scan_from = std::vector<uint32_t>(routes.size(), kNone);
+    auto scanned = std::vector<uint32_t>();
+
+    auto journey_to = [&](size_t round) {
+        auto journey = std::make_shared<List<::Key>>();
+        for (auto airport = size_t(to);;) {
+            while (rounds[round][airport].arrival == kDateTimeMax)
+                round--;
+            auto& label = rounds[round][airport];
+            if (label.route == kNone)
+                return journey;
+            auto& route = routes[label.route];
+            for (auto stop = label.alight; stop-- > label.board;)
+                journey->push_front(flights[route.first_flight + stop * route.trip_count + label.trip]);
+            airport = route_stops[route.first_stop + label.board] - airport_range.min;
+            round--;
+        }
+    };
+
+    for (auto round = size_t(1); round <= size_t(max_rides) && !marked.empty(); round++) {
+        for (auto airport : marked) {
+            is_marked[airport] = false;
+            for (auto i = airport_offsets[airport]; i < airport_offsets[airport + 1]; i++) {
+                auto [route, stop] = airport_routes[i];
+                if (scan_from[route] == kNone)
+                    scanned.push_back(route);
+                scan_from[route] = std::min(scan_from[route], stop);
+            }
+        }
+        marked.clear();
+        std::copy(earliest.begin(), earliest.end(), previous.begin());
+        rounds.emplace_back(airports, unreached);
+        auto& labels = rounds.back();
+
+        for (auto index : scanned) {
+            auto& route = routes[index];
+            auto trip = kNone, board = kNone;
+            for (auto stop = std::exchange(scan_from[index], kNone); stop < route.stop_count; stop++) {
+                auto airport = route_stops[route.first_stop + stop] - airport_range.min;
+                auto times = route.first_time + stop * route.trip_count;
+                if (trip != kNone) {
+                    auto arrival = arrivals[times + trip];
+                    // Nothing that lands after the destination is reached can improve it.
+                    if (arrival <= datetime_to && arrival < std::min(earliest[airport], earliest[to])) {
+                        earliest[airport] = arrival;
+                        labels[airport] = {arrival, index, trip, board, stop};
+                        if (!is_marked[airport])
+                            is_marked[airport] = true, marked.push_back(airport);
+                    }
+                }
+                // An earlier trip may be caught here from the last round.
+                if (stop + 1 == route.stop_count || previous[airport] == kDateTimeMax ||
+                    (trip != kNone && previous[airport] > departures[times + trip]))
+                    continue;
+                auto column = departures.begin() + times;
+                auto earliest_trip = uint32_t(std::lower_bound(column, column + route.trip_count, previous[airport]) - column);
+                if (earliest_trip < std::min(trip, route.trip_count))
+                    trip = earliest_trip, board = stop;
+            }
+        }
+        scanned.clear();
+
+        if (labels[to].arrival != kDateTimeMax) {
+            result->push_back(journey_to(round));
+            if (first_only)
+                break;
+        }
+    }
+    return result;
+}
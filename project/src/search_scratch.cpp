@@ -0,0 +1,71 @@
+#include "../include/search_scratch.hpp"
+#include <algorithm>
+#include <mutex>
+#include <vector>
+
+void SearchScratch::Reset(size_t size) {
+    if (++generation == 0) {
+        // The counter wrapped around: stamps from 2^32 queries ago would look current.
+        for (auto& stamp : generations)
+            stamp = 0;
+        generation = 1;
+    }
+    // Frames and queue entries left behind by a search that threw.
+    while (!stack.empty())
+        stack.pop_back();
+    while (!heap.empty())
+        heap.pop_back();
+    for (auto& bucket : buckets)
+        while (!bucket.empty())
+            bucket.pop_back();
+    Reserve(size);
+}
+
+void SearchScratch::Reserve(size_t size) {
+    if (size <= generations.size())
+        return;
+    // Vector::resize allocates exactly, so grow geometrically past the first size.
+    if (!generations.empty())
+        size = std::max(size, generations.size() * 2);
+    generations.resize(size, 0);
+    status.resize(size, Status::UNDISCOVERED);
+    priority.resize(size, INT_MAX);
+    parent.resize(size, kNoNode);
+    heap_index.resize(size, kNotQueued);
+}
+
+namespace {
+
+// The free scratches of one thread. Other threads may return scratches to it,
+// hence the lock; it is never contended by the thread that owns it.
+struct ScratchPool {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<SearchScratch>> free;
+};
+
+thread_local auto pool = std::make_shared<ScratchPool>();
+
+}  // namespace
+
+std::shared_ptr<SearchScratch> SearchScratch::Acquire() {
+    auto scratch = std::unique_ptr<SearchScratch>();
+    {
+        auto lock = std::lock_guard(pool->mutex);
+        if (!pool->free.empty()) {
+            scratch = std::move(pool->free.back());
+            pool->free.pop_back();
+        }
+    }
+    if (!scratch)
+        scratch = std::make_unique<SearchScratch>();
+    // Goes back to the pool it came from, whichever thread drops it last, or
+    // is deleted if that thread has exited and taken its pool with it.
+    return std::shared_ptr<SearchScratch>(scratch.release(), [owner = std::weak_ptr(pool)](SearchScratch* scratch) {
+        if (auto pool = owner.lock()) {
+            auto lock = std::lock_guard(pool->mutex);
+            pool->free.emplace_back(scratch);
+        } else {
+            delete scratch;
+        }
+    });
+}
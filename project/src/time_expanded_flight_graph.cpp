@@ -0,0 +1,86 @@
+#include "../include/time_expanded_flight_graph.hpp"
+#include <algorithm>
+
+TimeExpandedFlightGraph::TimeExpandedFlightGraph(const FlightDatabase& flight_database)
+    : airport_range(flight_database.AirportRange()) {
+    auto airports = size_t(airport_range.max - airport_range.min + 1);
+    auto records = flight_database.RecordCount();
+    auto airport_to = flight_database.AirportToColumn();
+    auto datetime_from = flight_database.DateTimeFromColumn();
+    auto datetime_to = flight_database.DateTimeToColumn();
+    auto price = flight_database.PriceColumn();
+
+    // Nodes: the distinct arrival times of every airport.
+    node_offsets.reserve(airports + 1);
+    node_offsets.push_back(0);
+    node_airport.reserve(records);
+    node_datetime.reserve(records);
+    for (auto airport = airport_range.min; airport <= airport_range.max; airport++) {
+        auto first = node_datetime.size();
+        for (auto id : flight_database.QueryRecordIdsByAirportTo(airport)) {
+            auto datetime = datetime_to[id - 1];
+            if (node_datetime.size() > first && node_datetime[node_datetime.size() - 1] == datetime)
+                continue;
+            node_airport.push_back(airport);
+            node_datetime.push_back(datetime);
+        }
+        node_offsets.push_back(node_datetime.size());
+    }
+
+    // Edges: the departures of every airport, with the node each one arrives at.
+    edge_offsets.reserve(airports + 1);
+    edge_offsets.push_back(0);
+    edge_record.reserve(records);
+    edge_departure.reserve(records);
+    edge_arrival.reserve(records);
+    edge_target.reserve(records);
+    edge_price.reserve(records);
+    for (auto airport = airport_range.min; airport <= airport_range.max; airport++) {
+        for (auto id : flight_database.QueryRecordIdsByAirportFrom(airport)) {
+            auto index = id - 1;
+            edge_record.push_back(id);
+            edge_departure.push_back(datetime_from[index]);
+            earliest_departure = std::min(earliest_departure, datetime_from[index]);
+            edge_arrival.push_back(datetime_to[index]);
+            edge_target.push_back(*FindNode({airport_to[index], datetime_to[index]}));
+            edge_price.push_back(price[index]);
+        }
+        edge_offsets.push_back(edge_target.size());
+    }
+
+    node_first_edge.reserve(NodeCount());
+    for (NodeId node = 0; node < NodeCount(); node++)
+        node_first_edge.push_back(FirstEdgeFrom(node_airport[node], node_datetime[node]));
+}
+
+TimeExpandedFlightGraph::EdgeId TimeExpandedFlightGraph::FirstEdgeFrom(Airport airport, DateTime no_sooner_than) const {
+    auto index = airport - airport_range.min;
+    auto begin = edge_departure.begin() + edge_offsets[index];
+    auto end = edge_departure.begin() + edge_offsets[index + 1];
+    return std::lower_bound(begin, end, no_sooner_than) - edge_departure.begin();
+}
+
+std::optional<TimeExpandedFlightGraph::NodeId> TimeExpandedFlightGraph::FindNode(FlightNodeKey key) const {
+    auto [first, last] = NodesOf(key.airport);
+    auto begin = node_datetime.begin() + first, end = node_datetime.begin() + last;
+    auto found = std::lower_bound(begin, end, key.no_sooner_than);
+    if (found == end || *found != key.no_sooner_than)
+        return std::nullopt;
+    return NodeId(found - node_datetime.begin());
+}
+
+std::pair<TimeExpandedFlightGraph::NodeId, TimeExpandedFlightGraph::NodeId>
+TimeExpandedFlightGraph::NodesOf(Airport airport) const {
+    airport_range.WithinOrThrow(airport);
+    auto index = airport - airport_range.min;
+    return {node_offsets[index], node_offsets[index + 1]};
+}
+
+TimeExpandedFlightGraph::EdgeRange TimeExpandedFlightGraph::EdgesOf(NodeId node) const {
+    return {node_first_edge[node], edge_offsets[node_airport[node] - airport_range.min + 1]};
+}
+
+TimeExpandedFlightGraph::EdgeRange TimeExpandedFlightGraph::EdgesOf(FlightNodeKey key) const {
+    airport_range.WithinOrThrow(key.airport);
+    return {FirstEdgeFrom(key.airport, key.no_sooner_than), edge_offsets[key.airport - airport_range.min + 1]};
+}
@@ -0,0 +1,23 @@
+#include <cstdio>
+#include <string>
+#include "../include/flight_database.hpp"
+
+// Converts a flight CSV export into a .fdb snapshot that FlightDatabase can
+// map with LoadMode::SNAPSHOT.
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <input.csv> <output.fdb> [threads]\n", argv[0]);
+        return 2;
+    }
+    try {
+        auto threads = argc > 3 ? std::stoi(argv[3]) : 1;
+        auto db = FlightDatabase(argv[1], FlightDatabase::LoadMode::MAPPED, threads);
+        db.SaveSnapshot(argv[2]);
+        FlightDatabase::VerifySnapshot(argv[2]);
+        printf("Wrote %zu records to %s\n", db.RecordCount(), argv[2]);
+    } catch (const std::exception& e) {
+        fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
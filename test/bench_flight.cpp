@@ -0,0 +1,753 @@
+#include <catch2/benchmark/catch_benchmark.hpp>
+#include <catch2/catch_test_macros.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "../project/include/abstract_flight_graph_node_container.hpp"
+#include "../project/include/compact_flight_graph_node_container.hpp"
+#include "../project/include/bidirectional_search.hpp"
+#include "../project/include/connection_scan.hpp"
+#include "../project/include/csv_scanner.hpp"
+#include "../project/include/flat_flight_graph.hpp"
+#include "../project/include/flight_database.hpp"
+#include "../project/include/flight_graph_complete_with_price.hpp"
+#include "../project/include/flight_planner.hpp"
+#include "../project/include/mapped_file.hpp"
+#include "../project/include/raptor.hpp"
+#include "../project/include/search_scratch.hpp"
+#include "synthetic_schedule.hpp"
+
+// Benchmarks are hidden from the default run; use `./unit_test "[benchmark]"`.
+
+TEST_CASE("benchmark database loading", "[.][benchmark]") {
+    auto sample = std::string("../project/data/flight-data.csv");
+    auto synthetic = WriteSyntheticSchedule(1000000);
+
+    BENCHMARK("stream flight-data.csv") {
+        return FlightDatabase(sample, FlightDatabase::LoadMode::STREAM).AirportRange();
+    };
+    BENCHMARK("mapped flight-data.csv") {
+        return FlightDatabase(sample, FlightDatabase::LoadMode::MAPPED).AirportRange();
+    };
+    BENCHMARK("stream synthetic 1M rows") {
+        return FlightDatabase(synthetic, FlightDatabase::LoadMode::STREAM).AirportRange();
+    };
+    BENCHMARK("mapped synthetic 1M rows") {
+        return FlightDatabase(synthetic, FlightDatabase::LoadMode::MAPPED).AirportRange();
+    };
+    for (int threads : {2, 4, 8}) {
+        BENCHMARK("mapped synthetic 1M rows, " + std::to_string(threads) + " threads") {
+            return FlightDatabase(synthetic, FlightDatabase::LoadMode::MAPPED, threads).AirportRange();
+        };
+    }
+}
+
+TEST_CASE("benchmark record parsing", "[.][benchmark]") {
+    auto rows = 1000000;
+    auto file = MappedFile(WriteSyntheticSchedule(rows));
+    auto text = file.View().substr(file.View().find('\n') + 1);
+    auto parse = [&]() {
+        auto records = Vector<FlightDatabase::Record>();
+        records.reserve(rows);
+        FlightDatabase::ParseRecords(text, records);
+        return records.size();
+    };
+
+    for (auto kind : {CsvScanner::Kind::SCALAR, CsvScanner::Kind::SSE2, CsvScanner::Kind::AVX2}) {
+        if (!CsvScanner::Supported(kind))
+            continue;
+        CsvScanner::Select(kind);
+        BENCHMARK("parse 1M rows, " + CsvScanner::Name(kind)) {
+            return parse();
+        };
+        auto start = std::chrono::steady_clock::now();
+        parse();
+        auto seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        printf("%s: %.0f rows/s\n", CsvScanner::Name(kind).c_str(), rows / seconds);
+    }
+    CsvScanner::Select(CsvScanner::Detect());
+}
+
+TEST_CASE("benchmark snapshot startup", "[.][benchmark]") {
+    auto synthetic = WriteSyntheticSchedule(1000000);
+    auto snapshot = synthetic + ".fdb";
+    FlightDatabase(synthetic).SaveSnapshot(snapshot);
+
+    BENCHMARK("csv synthetic 1M rows") {
+        return FlightDatabase(synthetic).RecordCount();
+    };
+    BENCHMARK("snapshot synthetic 1M rows") {
+        return FlightDatabase(snapshot, FlightDatabase::LoadMode::SNAPSHOT).RecordCount();
+    };
+    BENCHMARK("snapshot synthetic 1M rows, verified") {
+        FlightDatabase::VerifySnapshot(snapshot);
+        return FlightDatabase(snapshot, FlightDatabase::LoadMode::SNAPSHOT).RecordCount();
+    };
+}
+
+TEST_CASE("benchmark record layout", "[.][benchmark]") {
+    auto db = FlightDatabase(WriteSyntheticSchedule(1000000));
+    printf("bytes per record: %zu as Record rows, %zu as columns\n",
+           sizeof(FlightDatabase::Record), FlightDatabase::kBytesPerRecord);
+
+    // The edge generation loop of FlightGraphComplete, once over rows and once over columns.
+    auto airports = db.AirportRange();
+    BENCHMARK("expand all departures, Record copies") {
+        auto checksum = 0ll;
+        for (auto airport = airports.min; airport <= airports.max; airport++)
+            for (auto id : db.QueryRecordIdsByAirportFrom(airport)) {
+                auto record = db.QueryRecordById(id);
+                checksum += record.airport_to + record.datetime_to - record.datetime_from;
+            }
+        return checksum;
+    };
+    BENCHMARK("expand all departures, columns") {
+        auto checksum = 0ll;
+        auto datetime_from = db.DateTimeFromColumn();
+        auto airport_to = db.AirportToColumn();
+        auto datetime_to = db.DateTimeToColumn();
+        for (auto airport = airports.min; airport <= airports.max; airport++)
+            for (auto id : db.QueryRecordIdsByAirportFrom(airport))
+                checksum += airport_to[id - 1] + datetime_to[id - 1] - datetime_from[id - 1];
+        return checksum;
+    };
+}
+
+TEST_CASE("benchmark route lookup", "[.][benchmark]") {
+    auto db = FlightDatabase(WriteSyntheticSchedule(1000000));
+    // One lookup per path leg, as Planner::ConvertPath does it. The synthetic
+    // schedule repeats some (from, to, arrival) triples, so both sum every match.
+    auto legs = std::vector<FlightDatabase::Record>();
+    for (Key id = 1; id <= 1000000; id += 997)
+        legs.push_back(db.QueryRecordById(id));
+
+    BENCHMARK("arrival lookup, origin bucket scan") {
+        auto checksum = 0ll;
+        for (auto& leg : legs)
+            for (auto id : db.QueryRecordIdsByAirportFrom(leg.airport_from))
+                if (db.AirportToColumn()[id - 1] == leg.airport_to && db.DateTimeToColumn()[id - 1] == leg.datetime_to)
+                    checksum += id;
+        return checksum;
+    };
+    BENCHMARK("arrival lookup, route index") {
+        auto checksum = 0ll;
+        for (auto& leg : legs)
+            for (auto id : db.QueryRecordIdsByRouteArrival(leg.airport_from, leg.airport_to, leg.datetime_to, leg.datetime_to))
+                checksum += id;
+        return checksum;
+    };
+}
+
+TEST_CASE("benchmark airport bucket index", "[.][benchmark]") {
+    auto db = FlightDatabase(WriteSyntheticSchedule(1000000));
+    auto airports = db.AirportRange();
+    auto airport_from = db.AirportFromColumn();
+    auto datetime_from = db.DateTimeFromColumn();
+    auto ids = std::vector<Key>();
+    for (Key id = 1; size_t(id) <= db.RecordCount(); id++)
+        ids.push_back(id);
+    auto by_departure = [&](Key a, Key b) { return datetime_from[a - 1] < datetime_from[b - 1]; };
+    auto build_legacy = [&] {
+        auto index = AbstractFlightGraphNodeContainer<Key>(airports);
+        for (auto id : ids)
+            index.Add(airport_from[id - 1], datetime_from[id - 1], id);
+        index.Sort(by_departure);
+        return index;
+    };
+    auto build_compact = [&] {
+        return CompactFlightGraphNodeContainer<Key>(
+            airports, ids, [&](Key id) { return airport_from[id - 1]; },
+            [&](Key id) { return datetime_from[id - 1]; }, by_departure);
+    };
+    auto legacy = build_legacy();
+    auto compact = build_compact();
+    auto legacy_bytes = size_t(0);
+    for (auto airport = airports.min; airport <= airports.max; airport++)
+        legacy_bytes += 2 * (sizeof(std::shared_ptr<Vector<Key>>) + sizeof(Vector<Key>)) +
+                        legacy.Get(airport)->capacity() * sizeof(Key) +
+                        legacy.GetDateTimes(airport)->capacity() * sizeof(DateTime);
+    printf("index bytes: %zu with a Vector pair per airport, %zu as CSR\n", legacy_bytes,
+           compact.Offsets().size_bytes() + compact.Elements().size_bytes() + compact.DateTimes().size_bytes());
+
+    BENCHMARK("build, Vector per airport") {
+        return build_legacy();
+    };
+    BENCHMARK("build, CSR") {
+        return build_compact();
+    };
+    BENCHMARK("scan all airports, Vector per airport") {
+        auto checksum = 0ll;
+        for (auto airport = airports.min; airport <= airports.max; airport++) {
+            auto bucket = legacy.Get(airport);
+            auto datetimes = legacy.GetDateTimes(airport);
+            for (size_t i = 0; i < bucket->size(); i++)
+                checksum += (*bucket)[i] + (*datetimes)[i];
+        }
+        return checksum;
+    };
+    BENCHMARK("scan all airports, CSR") {
+        auto checksum = 0ll;
+        for (auto airport = airports.min; airport <= airports.max; airport++) {
+            auto bucket = compact.Get(airport);
+            auto datetimes = compact.GetDateTimes(airport);
+            for (size_t i = 0; i < bucket.size(); i++)
+                checksum += bucket[i] + datetimes[i];
+        }
+        return checksum;
+    };
+}
+
+TEST_CASE("benchmark node pool lookup", "[.][benchmark]") {
+    // One airport holding `degree` nodes; every run performs the same 1000 lookups.
+    for (int degree : {10, 100, 1000, 10000, 100000}) {
+        auto pool = AbstractFlightGraphNodeContainer<int>({1, 1});
+        for (int i = 0; i < degree; i++)
+            pool.Add(1, i * 7, i);
+        auto keys = std::vector<DateTime>();
+        for (int i = 0; i < 1000; i++)
+            keys.push_back((i * 7919 % degree) * 7);
+
+        BENCHMARK("1000 lookups, hashed, degree " + std::to_string(degree)) {
+            auto checksum = 0ll;
+            for (auto key : keys)
+                checksum += *pool.Get(1, key);
+            return checksum;
+        };
+        // What Get used to do: scan every datetime stored for the airport.
+        BENCHMARK("1000 lookups, linear scan, degree " + std::to_string(degree)) {
+            auto checksum = 0ll;
+            auto datetimes = pool.GetDateTimes(1);
+            for (auto key : keys)
+                for (size_t i = 0; i < datetimes->size(); i++)
+                    if ((*datetimes)[i] == key)
+                        checksum += (*pool.Get(1))[i];
+            return checksum;
+        };
+    }
+}
+
+TEST_CASE("benchmark shared graph", "[.][benchmark]") {
+    auto db = std::make_shared<FlightDatabase>("../project/data/flight-data.csv");
+    auto from = FlightNodeKey{48, db->ParseDateTime("5/5/2017 0:00")};
+    auto to = FlightNodeKey{50, db->ParseDateTime("5/9/2017 23:59")};
+
+    BENCHMARK("all paths, shared_ptr nodes") {
+        auto graph = std::make_shared<FlightGraphComplete>(db);
+        return graph->AllPathsTo(graph->GetNode(from), graph->GetNode(to), 2)->size();
+    };
+    auto shared = std::make_shared<const TimeExpandedFlightGraph>(*db);
+    BENCHMARK("build time-expanded graph") {
+        return TimeExpandedFlightGraph(*db).EdgeCount();
+    };
+    BENCHMARK("all paths, shared time-expanded graph") {
+        auto graph = FlatFlightGraph(shared);
+        auto from_node = graph.GetNode(from);
+        return graph.AllPathsTo(from_node, graph.GetNode(to), 2)->size();
+    };
+    BENCHMARK("minimum cost path, shared_ptr nodes") {
+        auto graph = std::make_shared<FlightGraphCompleteWithPrice>(db);
+        return graph->BestPathTo(graph->GetNode(from), graph->GetNode(to)).has_value();
+    };
+    BENCHMARK("minimum cost path, shared time-expanded graph") {
+        auto graph = FlatFlightGraph(shared, FlatFlightGraph::Weight::PRICE);
+        auto from_node = graph.GetNode(from);
+        return graph.BestPathTo(from_node, graph.GetNode(to)).has_value();
+    };
+    printf("time-expanded graph: %zu nodes, %zu edges\n", shared->NodeCount(), shared->EdgeCount());
+}
+
+TEST_CASE("benchmark search scratch", "[.][benchmark]") {
+    auto db = std::make_shared<FlightDatabase>(WriteSyntheticSchedule(1000000));
+    auto shared = std::make_shared<const TimeExpandedFlightGraph>(*db);
+    auto airports = db->AirportRange();
+    printf("time-expanded graph: %zu nodes, %zu edges\n", shared->NodeCount(), shared->EdgeCount());
+
+    BENCHMARK("reset, fresh arrays") {
+        auto scratch = SearchScratch();
+        scratch.Reset(shared->NodeCount());
+        return scratch.Size();
+    };
+    BENCHMARK("reset, pooled scratch") {
+        auto scratch = SearchScratch::Acquire();
+        scratch->Reset(shared->NodeCount());
+        return scratch->Size();
+    };
+    // A shallow query touches a few nodes of a large graph, so the reset dominates.
+    BENCHMARK("all paths with depth limit 0, pooled scratch") {
+        auto search = FlatFlightGraph(shared);
+        auto from = search.GetNode({airports.min, kDateTimeMin});
+        return search.AllPathsTo(from, search.GetNode({airports.max, kDateTimeMax}), 0)->size();
+    };
+}
+
+TEST_CASE("benchmark visitor traversal", "[.][benchmark]") {
+    auto db = std::make_shared<FlightDatabase>("../project/data/flight-data.csv");
+    auto planner = Planner(db);
+    auto shared = planner.Graph();
+    auto from = FlightNodeKey{48, db->ParseDateTime("5/5/2017 0:00")};
+    auto to = FlightNodeKey{50, db->ParseDateTime("5/9/2017 23:59")};
+
+    // The listener-based AllPathsTo and airport enumeration that the visitors replaced.
+    BENCHMARK("all paths, events") {
+        auto search = FlatFlightGraph(shared);
+        auto from_node = search.GetNode(from), to_node = search.GetNode(to);
+        auto result = std::make_shared<List<FlatFlightGraph::Path>>();
+        auto stack = std::make_shared<List<FlatFlightGraph::NodeId>>();
+        search.OnNodeDiscovered.AddListener([stack](auto node) { stack->push_back(node); });
+        search.OnNodeVisited.AddListener([&, stack, result](auto node) {
+            if (node == to_node || search.IsContinuousChild(node, to_node)) {
+                auto path = std::make_shared<List<FlatFlightGraph::NodeId>>();
+                for (auto node : *stack)
+                    path->push_back(node);
+                result->push_back(path);
+            }
+            stack->pop_back();
+        });
+        search.DFS(from_node, 2);
+        return result->size();
+    };
+    BENCHMARK("all paths, visitor") {
+        auto search = FlatFlightGraph(shared);
+        auto from_node = search.GetNode(from);
+        return search.AllPathsTo(from_node, search.GetNode(to), 2)->size();
+    };
+    BENCHMARK("airport DFS, events") {
+        auto search = FlatFlightGraph(shared);
+        auto result = std::make_shared<List<Airport>>();
+        auto sync = [&](FlatFlightGraph::NodeId node, FlatFlightGraph::Status status, bool discover) {
+            auto [first, last] = shared->NodesOf(search.Key(node).airport);
+            for (auto node = first; node < last; node++)
+                if (search.GetStatus(node) == status)
+                    discover ? search.Discover(node, false) : search.Visit(node, false);
+        };
+        search.OnNodeDiscovered.AddListener([&](auto node) { sync(node, FlatFlightGraph::Status::UNDISCOVERED, true); });
+        search.OnNodeVisited.AddListener([&](auto node) { sync(node, FlatFlightGraph::Status::DISCOVERED, false); });
+        search.OnNodeDiscovered.AddListener([&](auto node) { result->push_back(search.Key(node).airport); });
+        search.DFS(search.GetNode(from));
+        return result->size();
+    };
+    BENCHMARK("airport DFS, visitor") {
+        return planner.EnumerateAirportsDFS(from.airport, from.no_sooner_than)->size();
+    };
+}
+
+// The exception-based BestPathTo that the stop signal replaced.
+struct ThrowingPathVisitor : FlatFlightGraph::Visitor {
+    const FlatFlightGraph& search;
+    FlatFlightGraph::NodeId to;
+
+    ThrowingPathVisitor(const FlatFlightGraph& search, FlatFlightGraph::NodeId to)
+        : search(search), to(to) {}
+    FlatFlightGraph::Control Visit(FlatFlightGraph::NodeId node) {
+        if (search.IsContinuousChild(node, to))
+            throw search.GetPath(node);
+        return FlatFlightGraph::Control::CONTINUE;
+    }
+};
+
+TEST_CASE("benchmark early termination", "[.][benchmark]") {
+    auto db = std::make_shared<FlightDatabase>("../project/data/flight-data.csv");
+    auto planner = Planner(db);
+    auto shared = planner.Graph();
+    struct Query {
+        std::string name;
+        FlatFlightGraph::Weight weight;
+        FlightNodeKey from, to;
+    };
+    // The queries of "test shortest_path" and "test minimum_cost_path".
+    auto queries = {
+        Query{"shortest_path", FlatFlightGraph::Weight::TIME,
+              {39, db->ParseDateTime("5/6/2017 0:00")}, {10, db->ParseDateTime("5/8/2017 0:00")}},
+        Query{"minimum_cost_path", FlatFlightGraph::Weight::PRICE,
+              {28, db->ParseDateTime("5/5/2017 0:00")}, {74, db->ParseDateTime("5/9/2017 23:59")}},
+    };
+    for (auto& query : queries) {
+        BENCHMARK(query.name + ", throwing visitor") {
+            auto search = FlatFlightGraph(shared, query.weight);
+            auto from = search.GetNode(query.from);
+            auto visitor = ThrowingPathVisitor(search, search.GetNode(query.to));
+            try {
+                search.PFS(from, visitor);
+            } catch (FlatFlightGraph::Path path) {
+                return path->size();
+            }
+            return size_t(0);
+        };
+        BENCHMARK(query.name + ", stop signal") {
+            auto search = FlatFlightGraph(shared, query.weight);
+            auto from = search.GetNode(query.from);
+            return search.BestPathTo(from, search.GetNode(query.to)).has_value();
+        };
+        BENCHMARK(query.name + ", planner") {
+            auto& [airport_from, datetime_from] = query.from;
+            auto& [airport_to, datetime_to] = query.to;
+            return query.weight == FlatFlightGraph::Weight::TIME
+                       ? planner.QueryMinimumTimePath(airport_from, airport_to, datetime_from, datetime_to).has_value()
+                       : planner.QueryMinimumCostPath(airport_from, airport_to, datetime_from, datetime_to).has_value();
+        };
+    }
+    BENCHMARK("minimum_cost_path, shared_ptr nodes") {
+        auto& query = *(queries.begin() + 1);
+        auto graph = std::make_shared<FlightGraphCompleteWithPrice>(db);
+        return graph->BestPathTo(graph->GetNode(query.from), graph->GetNode(query.to)).has_value();
+    };
+}
+
+// Counts the queue work of PFS, which pushes a node once, on discovery.
+struct QueueCountingVisitor : FlatFlightGraph::Visitor {
+    const FlatFlightGraph& search;
+    FlatFlightGraph::NodeId to;
+    size_t pushes = 0, pops = 0;
+
+    QueueCountingVisitor(const FlatFlightGraph& search, FlatFlightGraph::NodeId to)
+        : search(search), to(to) {}
+    FlatFlightGraph::Control Discover(FlatFlightGraph::NodeId) {
+        pushes++;
+        return FlatFlightGraph::Control::CONTINUE;
+    }
+    FlatFlightGraph::Control Visit(FlatFlightGraph::NodeId node) {
+        pops++;
+        return search.IsContinuousChild(node, to) ? FlatFlightGraph::Control::STOP : FlatFlightGraph::Control::CONTINUE;
+    }
+};
+
+TEST_CASE("benchmark dijkstra", "[.][benchmark]") {
+    for (auto file : {std::string("../project/data/flight-data.csv"), WriteSyntheticSchedule(1000000)}) {
+        auto db = std::make_shared<FlightDatabase>(file);
+        auto shared = std::make_shared<const TimeExpandedFlightGraph>(*db);
+        auto airports = db->AirportRange();
+        auto from_datetime = MakeDateTime(2017, 5, 5, 0, 0), to_datetime = MakeDateTime(2017, 5, 9, 23, 59);
+        auto name = file.substr(file.find_last_of('/') + 1);
+
+        for (auto weight : {FlatFlightGraph::Weight::TIME, FlatFlightGraph::Weight::PRICE}) {
+            auto label = name + (weight == FlatFlightGraph::Weight::TIME ? ", time" : ", price");
+            auto pfs_pushes = size_t(0), pfs_pops = size_t(0), found = size_t(0);
+            auto stats = FlatFlightGraph::SearchStats();
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++) {
+                auto from = FlightNodeKey{airports.min, from_datetime}, to = FlightNodeKey{airport_to, to_datetime};
+                auto pfs = FlatFlightGraph(shared, weight);
+                auto visitor = QueueCountingVisitor(pfs, pfs.GetNode(to));
+                pfs.PFS(pfs.GetNode(from), visitor);
+                pfs_pushes += visitor.pushes, pfs_pops += visitor.pops;
+                auto dijkstra = FlatFlightGraph(shared, weight);
+                auto from_node = dijkstra.GetNode(from);
+                found += dijkstra.ShortestPathTo(from_node, dijkstra.GetNode(to)).has_value();
+                stats.pushes += dijkstra.Stats().pushes;
+                stats.pops += dijkstra.Stats().pops;
+                stats.decrease_keys += dijkstra.Stats().decrease_keys;
+            }
+            auto queries = double(airports.max - airports.min + 1);
+            printf("%s: %zu nodes, %.0f queries (%zu reachable), per query:\n", label.c_str(), shared->NodeCount(), queries, found);
+            printf("  PFS, binary heap:      %.1f pushes, %.1f pops\n", pfs_pushes / queries, pfs_pops / queries);
+            printf("  Dijkstra, 4-ary heap:  %.1f pushes, %.1f pops, %.1f decrease-keys\n",
+                   stats.pushes / queries, stats.pops / queries, stats.decrease_keys / queries);
+
+            auto airport_to = airports.max;
+            BENCHMARK(label + ", PFS, binary heap") {
+                auto search = FlatFlightGraph(shared, weight);
+                auto from = search.GetNode({airports.min, from_datetime});
+                return search.BestPathTo(from, search.GetNode({airport_to, to_datetime})).has_value();
+            };
+            auto queues = {std::pair{FlatFlightGraph::Queue::BINARY_HEAP, "binary heap"},
+                           std::pair{FlatFlightGraph::Queue::QUATERNARY_HEAP, "4-ary heap"},
+                           std::pair{FlatFlightGraph::Queue::RADIX_HEAP, "radix heap"}};
+            for (auto [queue, queue_name] : queues) {
+                BENCHMARK(label + ", Dijkstra, " + queue_name) {
+                    auto search = FlatFlightGraph(shared, weight);
+                    auto from = search.GetNode({airports.min, from_datetime});
+                    return search.ShortestPathTo(from, search.GetNode({airport_to, to_datetime}), queue).has_value();
+                };
+            }
+        }
+    }
+}
+
+TEST_CASE("benchmark connection scan", "[.][benchmark]") {
+    for (auto file : {std::string("../project/data/flight-data.csv"), WriteSyntheticSchedule(1000000)}) {
+        auto db = std::make_shared<FlightDatabase>(file);
+        auto planner = Planner(db);
+        auto airports = db->AirportRange();
+        auto from_datetime = MakeDateTime(2017, 5, 5, 0, 0), to_datetime = MakeDateTime(2017, 5, 9, 23, 59);
+        auto name = file.substr(file.find_last_of('/') + 1);
+
+        BENCHMARK(name + ", build connection array") {
+            return ConnectionScan(*db).Connections().size();
+        };
+        // shortest_path from one airport to every airport.
+        BENCHMARK(name + ", shortest_path to all, Dijkstra") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++) {
+                auto search = FlatFlightGraph(planner.Graph(), FlatFlightGraph::Weight::TIME);
+                auto from = search.GetNode({airports.min, from_datetime});
+                found += search.ShortestPathTo(from, search.GetNode({airport_to, to_datetime})).has_value();
+            }
+            return found;
+        };
+        BENCHMARK(name + ", shortest_path to all, CSA") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                found += planner.Connections()->EarliestArrival(airports.min, airport_to, from_datetime, to_datetime).has_value();
+            return found;
+        };
+        // A one-day window, where the scan stops early.
+        BENCHMARK(name + ", shortest_path to all within a day, Dijkstra") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++) {
+                auto search = FlatFlightGraph(planner.Graph(), FlatFlightGraph::Weight::TIME);
+                auto from = search.GetNode({airports.min, from_datetime});
+                found += search.ShortestPathTo(from, search.GetNode({airport_to, from_datetime + 24 * 60})).has_value();
+            }
+            return found;
+        };
+        BENCHMARK(name + ", shortest_path to all within a day, CSA") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                found += planner.Connections()->EarliestArrival(airports.min, airport_to, from_datetime, from_datetime + 24 * 60).has_value();
+            return found;
+        };
+    }
+}
+
+TEST_CASE("benchmark arrival profile", "[.][benchmark]") {
+    for (auto file : {std::string("../project/data/flight-data.csv"), WriteSyntheticSchedule(1000000)}) {
+        auto db = std::make_shared<FlightDatabase>(file);
+        auto planner = Planner(db);
+        auto airports = db->AirportRange();
+        auto name = file.substr(file.find_last_of('/') + 1);
+        // A booking day of half-hour departure slots, arriving within three days,
+        // to every tenth airport.
+        auto day = MakeDateTime(2017, 5, 6, 0, 0), deadline = day + 3 * 24 * 60;
+        constexpr int kSlots = 48;
+
+        BENCHMARK(name + ", " + std::to_string(kSlots) + " slots to 8 airports, shortest_path per slot, Dijkstra") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to += 10)
+                for (int slot = 0; slot < kSlots; slot++) {
+                    auto search = FlatFlightGraph(planner.Graph(), FlatFlightGraph::Weight::TIME);
+                    auto from = search.GetNode({airports.min, day + slot * 30});
+                    found += search.ShortestPathTo(from, search.GetNode({airport_to, deadline})).has_value();
+                }
+            return found;
+        };
+        BENCHMARK(name + ", " + std::to_string(kSlots) + " slots to 8 airports, shortest_path per slot, CSA") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to += 10)
+                for (int slot = 0; slot < kSlots; slot++)
+                    found += planner.QueryMinimumTimePath(airports.min, airport_to, day + slot * 30, deadline).has_value();
+            return found;
+        };
+        BENCHMARK(name + ", " + std::to_string(kSlots) + " slots to 8 airports, one profile") {
+            auto found = size_t(0);
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to += 10)
+                found += planner.QueryArrivalProfile(airports.min, airport_to, day, deadline)->size();
+            return found;
+        };
+    }
+}
+
+TEST_CASE("benchmark a star", "[.][benchmark]") {
+    for (auto file : {std::string("../project/data/flight-data.csv"), WriteSyntheticSchedule(1000000)}) {
+        auto db = std::make_shared<FlightDatabase>(file);
+        auto planner = Planner(db);
+        auto airports = db->AirportRange();
+        auto from_datetime = MakeDateTime(2017, 5, 5, 0, 0), to_datetime = MakeDateTime(2017, 5, 9, 23, 59);
+        auto name = file.substr(file.find_last_of('/') + 1);
+
+        BENCHMARK(name + ", lower bounds to one airport") {
+            return AirportLowerBounds(*db).To(airports.max)->price.size();
+        };
+        for (auto weight : {FlatFlightGraph::Weight::TIME, FlatFlightGraph::Weight::PRICE}) {
+            auto label = name + (weight == FlatFlightGraph::Weight::TIME ? ", time" : ", price");
+            auto query = [&](Airport airport_to, bool guided) {
+                auto search = FlatFlightGraph(planner.Graph(), weight);
+                auto from = search.GetNode({airports.min, from_datetime});
+                auto to = search.GetNode({airport_to, to_datetime});
+                auto path = guided ? search.ShortestPathTo(from, to, *planner.Bounds()->To(airport_to))
+                                   : search.ShortestPathTo(from, to);
+                return search.Stats().pops;
+            };
+            auto settled = size_t(0), settled_guided = size_t(0);
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                settled += query(airport_to, false), settled_guided += query(airport_to, true);
+            auto queries = double(airports.max - airports.min + 1);
+            printf("%s: %zu nodes, settled per query: %.1f Dijkstra, %.1f A*\n", label.c_str(),
+                   planner.Graph()->NodeCount(), settled / queries, settled_guided / queries);
+
+            BENCHMARK(label + ", to all airports, Dijkstra") {
+                auto settled = size_t(0);
+                for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                    settled += query(airport_to, false);
+                return settled;
+            };
+            BENCHMARK(label + ", to all airports, A*") {
+                auto settled = size_t(0);
+                for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                    settled += query(airport_to, true);
+                return settled;
+            };
+        }
+    }
+}
+
+TEST_CASE("benchmark bidirectional search", "[.][benchmark]") {
+    for (auto file : {std::string("../project/data/flight-data.csv"), WriteSyntheticSchedule(1000000)}) {
+        auto db = std::make_shared<FlightDatabase>(file);
+        auto planner = Planner(db);
+        auto airports = db->AirportRange();
+        auto from_datetime = MakeDateTime(2017, 5, 5, 0, 0), to_datetime = MakeDateTime(2017, 5, 9, 23, 59);
+        auto name = file.substr(file.find_last_of('/') + 1);
+        auto forward = [&](Airport airport_to, bool guided) {
+            auto search = FlatFlightGraph(planner.Graph(), FlatFlightGraph::Weight::PRICE);
+            auto from = search.GetNode({airports.min, from_datetime});
+            auto to = search.GetNode({airport_to, to_datetime});
+            auto path = guided ? search.ShortestPathTo(from, to, *planner.Bounds()->To(airport_to))
+                               : search.ShortestPathTo(from, to);
+            return search.Stats().pops;
+        };
+        auto bidirectional = [&](Airport airport_to) {
+            auto search = BidirectionalSearch(*db);
+            auto journey = search.MinimumCost(airports.min, airport_to, from_datetime, to_datetime);
+            return search.Stats().forward + search.Stats().backward;
+        };
+
+        auto settled = size_t(0), settled_guided = size_t(0), settled_bidirectional = size_t(0);
+        for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++) {
+            settled += forward(airport_to, false), settled_guided += forward(airport_to, true);
+            settled_bidirectional += bidirectional(airport_to);
+        }
+        auto queries = double(airports.max - airports.min + 1);
+        printf("%s: %zu flights, settled per query: %.1f Dijkstra, %.1f A*, %.1f bidirectional\n", name.c_str(),
+               db->RecordCount(), settled / queries, settled_guided / queries, settled_bidirectional / queries);
+
+        BENCHMARK(name + ", to all airports, Dijkstra") {
+            auto settled = size_t(0);
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                settled += forward(airport_to, false);
+            return settled;
+        };
+        BENCHMARK(name + ", to all airports, A*") {
+            auto settled = size_t(0);
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                settled += forward(airport_to, true);
+            return settled;
+        };
+        BENCHMARK(name + ", to all airports, bidirectional") {
+            auto settled = size_t(0);
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                settled += bidirectional(airport_to);
+            return settled;
+        };
+    }
+}
+
+TEST_CASE("benchmark pareto paths", "[.][benchmark]") {
+    for (auto file : {std::string("../project/data/flight-data.csv"), WriteSyntheticSchedule(1000000)}) {
+        auto db = std::make_shared<FlightDatabase>(file);
+        auto planner = Planner(db);
+        auto airports = db->AirportRange();
+        auto from_datetime = MakeDateTime(2017, 5, 5, 0, 0), to_datetime = MakeDateTime(2017, 5, 9, 23, 59);
+        auto name = file.substr(file.find_last_of('/') + 1);
+        // The engines behind the planner's queries, without the conversion to
+        // records, which cannot name a flight by its arrival on synthetic data.
+        auto pareto = [&](Airport airport_to, bool bounded) {
+            auto bounds = bounded ? planner.Bounds()->To(airport_to) : nullptr;
+            return planner.Connections()->ParetoJourneys(airports.min, airport_to, from_datetime, to_datetime, bounds.get())->size();
+        };
+
+        auto paths = size_t(0), queries = size_t(0);
+        for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++, queries++)
+            paths += pareto(airport_to, true);
+        printf("%s: %.2f Pareto paths per query\n", name.c_str(), double(paths) / queries);
+
+        BENCHMARK(name + ", to all airports, minimum time and minimum cost") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++) {
+                found += planner.Connections()->EarliestArrival(airports.min, airport_to, from_datetime, to_datetime).has_value();
+                auto search = FlatFlightGraph(planner.Graph(), FlatFlightGraph::Weight::PRICE);
+                auto from = search.GetNode({airports.min, from_datetime});
+                auto to = search.GetNode({airport_to, to_datetime});
+                found += search.ShortestPathTo(from, to, *planner.Bounds()->To(airport_to)).has_value();
+            }
+            return found;
+        };
+        BENCHMARK(name + ", to all airports, Pareto paths") {
+            auto found = size_t(0);
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                found += pareto(airport_to, false);
+            return found;
+        };
+        BENCHMARK(name + ", to all airports, Pareto paths with bounds") {
+            auto found = size_t(0);
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                found += pareto(airport_to, true);
+            return found;
+        };
+    }
+}
+
+TEST_CASE("benchmark raptor", "[.][benchmark]") {
+    for (auto file : {std::string("../project/data/flight-data.csv"), WriteSyntheticSchedule(1000000)}) {
+        auto db = std::make_shared<FlightDatabase>(file);
+        auto planner = Planner(db);
+        auto airports = db->AirportRange();
+        auto from_datetime = MakeDateTime(2017, 5, 5, 0, 0), to_datetime = MakeDateTime(2017, 5, 9, 23, 59);
+        auto name = file.substr(file.find_last_of('/') + 1);
+        // The PFS-based engine: a BFS of the time-expanded graph that stops at
+        // the first node the destination is reached from.
+        auto bfs = [&](Airport airport_to) {
+            auto search = FlatFlightGraph(planner.Graph());
+            auto visitor = QueueCountingVisitor(search, search.GetNode({airport_to, to_datetime}));
+            search.BFS(search.GetNode({airports.min, from_datetime}), visitor);
+            return visitor.pops;
+        };
+
+        auto journeys = size_t(0), found = size_t(0), popped = size_t(0);
+        for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++) {
+            journeys += planner.Trips()->Journeys(airports.min, airport_to, from_datetime, to_datetime)->size();
+            found += planner.Trips()->FewestTransfers(airports.min, airport_to, from_datetime, to_datetime).has_value();
+            popped += bfs(airport_to);
+        }
+        auto queries = double(airports.max - airports.min + 1);
+        printf("%s: %zu flights, %zu trips, %zu routes; per query: %.2f journeys, %.1f BFS pops; %zu reachable\n",
+               name.c_str(), db->RecordCount(), planner.Trips()->TripCount(), planner.Trips()->RouteCount(),
+               journeys / queries, popped / queries, found);
+
+        BENCHMARK(name + ", build routes") {
+            return Raptor(*db).RouteCount();
+        };
+        BENCHMARK(name + ", to all airports, BFS") {
+            auto popped = size_t(0);
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                popped += bfs(airport_to);
+            return popped;
+        };
+        BENCHMARK(name + ", to all airports, PFS by time") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++) {
+                auto search = FlatFlightGraph(planner.Graph(), FlatFlightGraph::Weight::TIME);
+                auto from = search.GetNode({airports.min, from_datetime});
+                found += search.BestPathTo(from, search.GetNode({airport_to, to_datetime})).has_value();
+            }
+            return found;
+        };
+        BENCHMARK(name + ", to all airports, connection scan") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                found += planner.Connections()->EarliestArrival(airports.min, airport_to, from_datetime, to_datetime).has_value();
+            return found;
+        };
+        BENCHMARK(name + ", to all airports, RAPTOR fewest transfers") {
+            auto found = 0;
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                found += planner.Trips()->FewestTransfers(airports.min, airport_to, from_datetime, to_datetime).has_value();
+            return found;
+        };
+        BENCHMARK(name + ", to all airports, RAPTOR all rounds") {
+            auto journeys = size_t(0);
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++)
+                journeys += planner.Trips()->Journeys(airports.min, airport_to, from_datetime, to_datetime)->size();
+            return journeys;
+        };
+    }
+}
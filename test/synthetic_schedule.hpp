@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include "../project/include/flight_types.hpp"
+
+// A temporary name next to `path` that no other process writing `path` at
+// the same time picks; each writes its own file, then renames it over `path`.
+inline std::filesystem::path TemporaryPathFor(const std::filesystem::path& path) {
+    auto suffix = uint64_t(std::random_device()()) << 32 | std::random_device()();
+    auto temporary = path;
+    temporary += "." + std::to_string(suffix) + ".tmp";
+    return temporary;
+}
+
+// Writes a random schedule in the same CSV layout as project/data/flight-data.csv
+// and returns its path. The same (rows, airports, seed) always yields the same file.
+inline std::string WriteSyntheticSchedule(int rows, int airports = 80, unsigned seed = 2017) {
+    auto path = std::filesystem::temp_directory_path() /
+                ("flight-synthetic-" + std::to_string(rows) + "-" + std::to_string(airports) + "-" +
+                 std::to_string(seed) + ".csv");
+    if (std::filesystem::exists(path))
+        return path.string();
+    auto random = std::mt19937(seed);
+    auto airport = std::uniform_int_distribution<int>(1, airports);
+    auto day = std::uniform_int_distribution<int>(5, 24);
+    auto minute = std::uniform_int_distribution<int>(0, 24 * 60 - 1);
+    auto duration = std::uniform_int_distribution<int>(40, 300);
+    auto price = std::uniform_int_distribution<int>(100, 3000);
+    auto format = [](int day, int minute) {
+        day += minute / (24 * 60);
+        minute %= 24 * 60;
+        return "5/" + std::to_string(day) + "/2017 " + std::to_string(minute / 60) + ":" +
+               (minute % 60 < 10 ? "0" : "") + std::to_string(minute % 60);
+    };
+    auto temporary = TemporaryPathFor(path);
+    {
+        auto file = std::ofstream(temporary);
+        file << "Flight ID,Departure date,Intl/Dome,Flight NO.,Departure airport,Arrival airport,"
+                "Departure Time,Arrival Time,Airplane ID,Airplane Model,Air fares\n";
+        for (int id = 1; id <= rows; id++) {
+            auto from = airport(random);
+            auto to = airport(random);
+            while (to == from)
+                to = airport(random);
+            auto departure_day = day(random);
+            auto departure = minute(random);
+            auto arrival = departure + duration(random);
+            file << id << ",5/" << departure_day << "/2017,Dome," << id % 997 << "," << from << "," << to << ","
+                 << format(departure_day, departure) << "," << format(departure_day, arrival) << ","
+                 << id % 113 << "," << id % 3 + 1 << "," << price(random) << "\n";
+        }
+    }
+    std::filesystem::rename(temporary, path);
+    return path.string();
+}
+
+// Writes a schedule whose flights form one chain: flight i leaves the airport
+// flight i - 1 landed at, a minute after it landed. The airports repeat every
+// `airports` flights, so each one keeps a short departure row.
+inline std::string WriteChainSchedule(int flights, int airports = 50000) {
+    auto path = std::filesystem::temp_directory_path() /
+                ("flight-chain-" + std::to_string(flights) + "-" + std::to_string(airports) + ".csv");
+    if (std::filesystem::exists(path))
+        return path.string();
+    auto format = [](DateTime datetime) {
+        auto civil = CivilFromDateTime(datetime);
+        return std::to_string(civil.month) + "/" + std::to_string(civil.day) + "/" + std::to_string(civil.year) +
+               " " + std::to_string(civil.hour) + ":" + (civil.minute < 10 ? "0" : "") +
+               std::to_string(civil.minute);
+    };
+    auto start = MakeDateTime(2017, 1, 1, 0, 0);
+    auto temporary = TemporaryPathFor(path);
+    {
+        auto file = std::ofstream(temporary);
+        file << "Flight ID,Departure date,Intl/Dome,Flight NO.,Departure airport,Arrival airport,"
+                "Departure Time,Arrival Time,Airplane ID,Airplane Model,Air fares\n";
+        for (int id = 1; id <= flights; id++) {
+            auto departure = start + 2 * (id - 1);
+            auto civil = CivilFromDateTime(departure);
+            file << id << "," << civil.month << "/" << civil.day << "/" << civil.year << ",Dome," << id % 997 << ","
+                 << (id - 1) % airports + 1 << "," << id % airports + 1 << "," << format(departure) << ","
+                 << format(departure + 1) << "," << id % 113 << "," << id % 3 + 1 << ",100\n";
+        }
+    }
+    std::filesystem::rename(temporary, path);
+    return path.string();
+}
@@ -1,5 +1,14 @@
 #include <catch2/catch_test_macros.hpp>
+#include <climits>
+#include <deque>
+#include <numeric>
+#include <set>
+#include <thread>
+#include "../project/include/bidirectional_search.hpp"
+#include "../project/include/flight_graph_complete_with_price.hpp"
+#include "../project/include/flight_graph_complete_with_time.hpp"
 #include "../project/include/flight_planner.hpp"
+#include "synthetic_schedule.hpp"
 
 auto PathToString(Planner::Path path) {
     auto str = std::string();
@@ -17,6 +26,278 @@ auto PathListToString(Planner::PathList path_list) {
     return str;
 }
 
+// Runs the same query on the shared_ptr node graph and on the flat graph and
+// returns the node keys of the results, which must agree.
+template <typename Graph>
+auto NodeGraphPaths(std::shared_ptr<FlightDatabase> db, FlightNodeKey from, FlightNodeKey to, bool all_paths) {
+    auto graph = std::make_shared<Graph>(db);
+    auto keys = std::vector<std::vector<std::pair<Airport, DateTime>>>();
+    auto add = [&](auto path) {
+        keys.emplace_back();
+        for (auto& node : *path)
+            keys.back().push_back({node->Key().airport, node->Key().no_sooner_than});
+    };
+    if (all_paths) {
+        auto paths = graph->AllPathsTo(graph->GetNode(from), graph->GetNode(to), 2);
+        for (auto path : *paths)
+            add(path);
+    } else if (auto path = graph->BestPathTo(graph->GetNode(from), graph->GetNode(to))) {
+        add(*path);
+    }
+    return keys;
+}
+
+auto FlatGraphPaths(std::shared_ptr<const TimeExpandedFlightGraph> shared, FlatFlightGraph::Weight weight, FlightNodeKey from, FlightNodeKey to, bool all_paths) {
+    auto graph = FlatFlightGraph(shared, weight);
+    auto keys = std::vector<std::vector<std::pair<Airport, DateTime>>>();
+    auto add = [&](auto path) {
+        keys.emplace_back();
+        for (auto node : *path)
+            keys.back().push_back({graph.Key(node).airport, graph.Key(node).no_sooner_than});
+    };
+    auto from_node = graph.GetNode(from);
+    auto to_node = graph.GetNode(to);
+    if (all_paths) {
+        auto paths = graph.AllPathsTo(from_node, to_node, 2);
+        for (auto path : *paths)
+            add(path);
+    } else if (auto path = graph.BestPathTo(from_node, to_node)) {
+        add(*path);
+    }
+    return keys;
+}
+
+// The optimal cost of reaching `to` from `from`, by relaxing the nodes in time
+// order; a flight lands after it takes off, so that order is topological.
+std::optional<long> OptimalCost(const TimeExpandedFlightGraph& graph, FlatFlightGraph::Weight weight, FlightNodeKey from, FlightNodeKey to) {
+    auto cost = std::vector<long>(graph.NodeCount(), LONG_MAX);
+    auto relax = [&](TimeExpandedFlightGraph::EdgeRange edges, DateTime since, long base) {
+        for (auto edge = edges.begin; edge < edges.end; edge++) {
+            auto step = weight == FlatFlightGraph::Weight::PRICE ? long(graph.EdgePriceColumn()[edge])
+                                                                 : long(graph.EdgeArrivalColumn()[edge]) - since;
+            auto& target = cost[graph.EdgeTargetColumn()[edge]];
+            target = std::min(target, base + step);
+        }
+    };
+    relax(graph.EdgesOf(from), from.no_sooner_than, 0);
+    auto order = std::vector<TimeExpandedFlightGraph::NodeId>(graph.NodeCount());
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) {
+        return graph.Key(a).no_sooner_than < graph.Key(b).no_sooner_than;
+    });
+    auto best = std::optional<long>();
+    if (from.airport == to.airport && from.no_sooner_than <= to.no_sooner_than)
+        best = 0;
+    for (auto node : order) {
+        if (cost[node] == LONG_MAX)
+            continue;
+        relax(graph.EdgesOf(node), graph.Key(node).no_sooner_than, cost[node]);
+        auto key = graph.Key(node);
+        if (key.airport == to.airport && key.no_sooner_than <= to.no_sooner_than)
+            best = std::min(best.value_or(LONG_MAX), cost[node]);
+    }
+    return best;
+}
+
+// The fewest flights from `from` to `to`, by a BFS over the nodes.
+std::optional<long> FewestLegs(const TimeExpandedFlightGraph& graph, FlightNodeKey from, FlightNodeKey to) {
+    if (from.airport == to.airport && from.no_sooner_than <= to.no_sooner_than)
+        return 0;
+    auto legs = std::vector<long>(graph.NodeCount(), LONG_MAX);
+    auto queue = std::deque<TimeExpandedFlightGraph::NodeId>();
+    auto relax = [&](TimeExpandedFlightGraph::EdgeRange edges, long base) {
+        for (auto edge = edges.begin; edge < edges.end; edge++) {
+            auto target = graph.EdgeTargetColumn()[edge];
+            if (legs[target] == LONG_MAX)
+                legs[target] = base + 1, queue.push_back(target);
+        }
+    };
+    relax(graph.EdgesOf(from), 0);
+    for (; !queue.empty(); queue.pop_front()) {
+        auto node = queue.front();
+        auto key = graph.Key(node);
+        if (key.airport == to.airport && key.no_sooner_than <= to.no_sooner_than)
+            return legs[node];
+        relax(graph.EdgesOf(node), legs[node]);
+    }
+    return std::nullopt;
+}
+
+// Checks a Pareto set: its paths are journeys within the bounds, none beats
+// another, and each criterion's optimum is among them.
+void CheckParetoPaths(Planner& planner, const FlightDatabase& db, FlightNodeKey from, FlightNodeKey to) {
+    auto& graph = *planner.Graph();
+    auto paths = planner.QueryParetoPaths(from.airport, to.airport, from.no_sooner_than, to.no_sooner_than);
+    auto fastest = planner.Connections()->EarliestArrival(from.airport, to.airport, from.no_sooner_than, to.no_sooner_than);
+    REQUIRE(paths->empty() == !fastest.has_value());
+    // The bounds prune labels, not journeys.
+    REQUIRE(planner.Connections()->ParetoJourneys(from.airport, to.airport, from.no_sooner_than, to.no_sooner_than)->size() == paths->size());
+    if (paths->empty())
+        return;
+    auto criteria = std::vector<std::tuple<DateTime, long, long>>();
+    for (auto path : *paths) {
+        auto at = from;
+        auto price = 0l;
+        for (auto& record : *path) {
+            REQUIRE((record.airport_from == at.airport && record.datetime_from >= at.no_sooner_than));
+            at = {record.airport_to, record.datetime_to};
+            price += record.price;
+        }
+        REQUIRE((at.airport == to.airport && at.no_sooner_than <= to.no_sooner_than));
+        criteria.push_back({at.no_sooner_than, price, long(path->size())});
+    }
+    REQUIRE(std::is_sorted(criteria.begin(), criteria.end()));
+    for (auto& a : criteria)
+        for (auto& b : criteria)
+            if (&a != &b)
+                REQUIRE(!(std::get<0>(a) <= std::get<0>(b) && std::get<1>(a) <= std::get<1>(b) && std::get<2>(a) <= std::get<2>(b)));
+    auto [arrival, price, legs] = criteria[0];
+    for (auto [a, p, l] : criteria)
+        arrival = std::min(arrival, a), price = std::min(price, p), legs = std::min(legs, l);
+    REQUIRE(arrival == ((*fastest)->empty() ? from.no_sooner_than : db.QueryRecordById((*fastest)->back()).datetime_to));
+    REQUIRE(price == OptimalCost(graph, FlatFlightGraph::Weight::PRICE, from, to).value());
+    REQUIRE(legs == FewestLegs(graph, from, to).value());
+}
+
+// For every flight, the flight of the same number it continues, or -1: the
+// flights of a number in order of departure, where one leaves from where the
+// one before landed and no sooner.
+std::vector<long> ContinuedFlights(const FlightDatabase& db) {
+    auto order = std::vector<long>(db.RecordCount());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](long a, long b) {
+        return std::tie(db.FlightNumberColumn()[a], db.DateTimeFromColumn()[a], a) <
+               std::tie(db.FlightNumberColumn()[b], db.DateTimeFromColumn()[b], b);
+    });
+    auto continued = std::vector<long>(db.RecordCount(), -1);
+    for (size_t i = 1; i < order.size(); i++) {
+        auto a = order[i - 1], b = order[i];
+        if (db.FlightNumberColumn()[a] == db.FlightNumberColumn()[b] && db.AirportToColumn()[a] == db.AirportFromColumn()[b] &&
+            db.DateTimeToColumn()[a] <= db.DateTimeFromColumn()[b])
+            continued[b] = a;
+    }
+    return continued;
+}
+
+// The number of rides of a journey: a flight that continues the one before is
+// the same ride.
+long Rides(const std::vector<long>& continued, const List<Key>& journey) {
+    auto rides = 0l;
+    auto last = -1l;
+    for (auto id : journey)
+        rides += continued[id - 1] != last || last == -1, last = id - 1;
+    return rides;
+}
+
+// The fewest rides to take every flight, by relaxing flights in order of
+// departure, and from them the earliest arrival at `to` by number of rides
+// (index k for at most k + 1).
+std::vector<DateTime> EarliestArrivalByRides(const FlightDatabase& db, const std::vector<long>& continued, FlightNodeKey from, FlightNodeKey to) {
+    auto order = std::vector<long>(db.RecordCount());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](long a, long b) {
+        return std::tie(db.DateTimeFromColumn()[a], a) < std::tie(db.DateTimeFromColumn()[b], b);
+    });
+    auto rides = std::vector<long>(db.RecordCount(), LONG_MAX);
+    for (auto flight : order) {
+        if (db.DateTimeFromColumn()[flight] < from.no_sooner_than || db.DateTimeToColumn()[flight] > to.no_sooner_than)
+            continue;
+        if (db.AirportFromColumn()[flight] == from.airport)
+            rides[flight] = 1;
+        for (auto id : db.QueryRecordIdsByAirportTo(db.AirportFromColumn()[flight], kDateTimeMin, db.DateTimeFromColumn()[flight]))
+            if (rides[id - 1] != LONG_MAX)
+                rides[flight] = std::min(rides[flight], rides[id - 1] + (continued[flight] != id - 1));
+    }
+    auto earliest = std::vector<DateTime>();
+    for (auto flight = size_t(0); flight < rides.size(); flight++) {
+        if (rides[flight] == LONG_MAX || db.AirportToColumn()[flight] != to.airport)
+            continue;
+        if (earliest.size() < size_t(rides[flight]))
+            earliest.resize(rides[flight], kDateTimeMax);
+        earliest[rides[flight] - 1] = std::min(earliest[rides[flight] - 1], db.DateTimeToColumn()[flight]);
+    }
+    for (size_t k = 1; k < earliest.size(); k++)
+        earliest[k] = std::min(earliest[k], earliest[k - 1]);
+    return earliest;
+}
+
+// Checks the journeys of every RAPTOR round that improves the arrival against
+// the reference, and the fewest transfers query against the first of them.
+void CheckRounds(Planner& planner, const FlightDatabase& db, const std::vector<long>& continued, FlightNodeKey from, FlightNodeKey to) {
+    auto journeys = planner.Trips()->Journeys(from.airport, to.airport, from.no_sooner_than, to.no_sooner_than);
+    auto fewest = planner.QueryFewestTransfersPath(from.airport, to.airport, from.no_sooner_than, to.no_sooner_than);
+    REQUIRE(fewest.has_value() == !journeys->empty());
+    if (from.airport == to.airport) {
+        REQUIRE((journeys->size() == 1 && journeys->front()->empty()));
+        return;
+    }
+    auto earliest = EarliestArrivalByRides(db, continued, from, to);
+    auto journey = journeys->begin();
+    for (size_t k = 0; k < earliest.size(); k++) {
+        if (earliest[k] == kDateTimeMax || (k > 0 && earliest[k] == earliest[k - 1]))
+            continue;
+        REQUIRE(journey != journeys->end());
+        auto at = from;
+        for (auto id : **journey) {
+            auto record = db.QueryRecordById(id);
+            REQUIRE((record.airport_from == at.airport && record.datetime_from >= at.no_sooner_than));
+            at = {record.airport_to, record.datetime_to};
+        }
+        REQUIRE((at.airport == to.airport && at.no_sooner_than == earliest[k]));
+        REQUIRE(Rides(continued, **journey) == long(k + 1));
+        journey++;
+    }
+    REQUIRE(journey == journeys->end());
+    if (fewest) {
+        auto ids = std::vector<Key>();
+        for (auto& record : **fewest)
+            ids.push_back(record.id);
+        REQUIRE(ids == std::vector<Key>(journeys->front()->begin(), journeys->front()->end()));
+    }
+}
+
+// The cost of a path of the flat graph, taking the cheapest flight between
+// consecutive nodes as Dijkstra does.
+long FlatPathCost(FlatFlightGraph& search, FlatFlightGraph::Path path, FlatFlightGraph::Weight weight) {
+    auto& graph = search.Graph();
+    if (weight == FlatFlightGraph::Weight::TIME)
+        return search.Key(path->back()).no_sooner_than - search.Key(path->front()).no_sooner_than;
+    auto cost = 0l;
+    for (auto to = path->begin(), from = to++; to != path->end(); from = to++) {
+        auto edges = graph.EdgesOf(search.Key(*from));
+        auto cheapest = long(INT_MAX);
+        for (auto edge = edges.begin; edge < edges.end; edge++)
+            if (graph.EdgeTargetColumn()[edge] == *to)
+                cheapest = std::min(cheapest, long(graph.EdgePriceColumn()[edge]));
+        cost += cheapest;
+    }
+    return cost;
+}
+
+long PathCost(Planner::Path path, FlatFlightGraph::Weight weight, DateTime datetime_from) {
+    if (weight == FlatFlightGraph::Weight::TIME)
+        return path->empty() ? 0 : (*path)[path->size() - 1].datetime_to - datetime_from;
+    auto cost = 0l;
+    for (auto& record : *path)
+        cost += record.price;
+    return cost;
+}
+
+// The price of a journey, checking that each flight leaves after the last one
+// lands and that it goes from `from` to `to` within the window.
+long JourneyPrice(const FlightDatabase& db, BidirectionalSearch::Journey journey, FlightNodeKey from, FlightNodeKey to) {
+    auto at = from;
+    auto cost = 0l;
+    for (auto id : *journey) {
+        auto record = db.QueryRecordById(id);
+        REQUIRE((record.airport_from == at.airport && record.datetime_from >= at.no_sooner_than));
+        at = {record.airport_to, record.datetime_to};
+        cost += record.price;
+    }
+    REQUIRE((at.airport == to.airport && at.no_sooner_than <= to.no_sooner_than));
+    return cost;
+}
+
 TEST_CASE("test flight", "[flight]") {
     auto db = std::make_shared<FlightDatabase>("../project/data/flight-data.csv");
     auto planner = std::make_shared<Planner>(db);
@@ -65,15 +346,442 @@ TEST_CASE("test flight", "[flight]") {
             auto str = PathToString(result.value());
             REQUIRE(str == "2113 471 1651 1733 ");
         }
+        {
+            // PFS kept the fare a node was first found with and paid 2857 here.
+            auto result = planner->QueryMinimumCostPath(16, 72, db->ParseDateTime("5/5/2017 0:00"), db->ParseDateTime("5/9/2017 23:59"));
+            REQUIRE(PathToString(result.value()) == "229 1195 ");
+            auto price = 0;
+            for (auto& record : *result.value())
+                price += record.price;
+            REQUIRE(price == 2736);
+        }
         {
             REQUIRE_THROWS(planner->QueryMinimumCostPath(80, 1, db->ParseDateTime("5/10/2017 0:00"), db->ParseDateTime("10/0/2017 23:59")));
         }
     }
 
+    SECTION("test pareto_paths") {
+        auto from_datetime = db->ParseDateTime("5/5/2017 0:00");
+        auto to_datetime = db->ParseDateTime("5/9/2017 23:59");
+        for (auto airport_from : {28, 39, 48})
+            for (auto airport_to = db->AirportRange().min; airport_to <= db->AirportRange().max; airport_to++)
+                CheckParetoPaths(*planner, *db, {airport_from, from_datetime}, {airport_to, to_datetime});
+        REQUIRE(planner->QueryParetoPaths(39, 39, from_datetime, to_datetime)->front()->empty());
+        REQUIRE(planner->QueryParetoPaths(39, 10, to_datetime, from_datetime)->empty());
+    }
+
+    SECTION("test fewest_transfers") {
+        auto continued = ContinuedFlights(*db);
+        REQUIRE(std::count(continued.begin(), continued.end(), -1) == 2346 - 614);
+        REQUIRE(planner->Trips()->TripCount() == 2346 - 614);
+        auto from_datetime = db->ParseDateTime("5/5/2017 0:00");
+        auto to_datetime = db->ParseDateTime("5/9/2017 23:59");
+        for (auto airport_from : {28, 39, 48})
+            for (auto airport_to = db->AirportRange().min; airport_to <= db->AirportRange().max; airport_to++)
+                CheckRounds(*planner, *db, continued, {airport_from, from_datetime}, {airport_to, to_datetime});
+        auto path = planner->QueryFewestTransfersPath(39, 10, from_datetime, to_datetime);
+        REQUIRE(PathToString(path.value()) == "2300 1369 ");
+    }
+
     SECTION("test all_paths") {
         {
             auto result = planner->EnumerateAllPaths(39, 52, db->ParseDateTime("5/5/2017 0:00"), db->ParseDateTime("5/9/2017 23:59"));
             REQUIRE(result->size() == 8);
         }
     };
+    SECTION("test node pool") {
+        auto pool = AbstractFlightGraphNodeContainer<int>({1, 3});
+        for (int i = 0; i < 1000; i++)
+            pool.Add(1 + i % 3, 1000 - i, i);
+        REQUIRE_THROWS(pool.Add(2, 999, -1));
+        REQUIRE_THROWS(pool.Add(4, 0, -1));
+        REQUIRE(pool.Get(2)->size() == 333);
+        pool.Sort([](int a, int b) { return a > b; });
+        for (int i = 0; i < 1000; i++)
+            REQUIRE(pool.Get(1 + i % 3, 1000 - i) == i);
+        REQUIRE(pool.Get(1, 999) == std::nullopt);
+        REQUIRE((*pool.Get(1))[0] == 999);
+    }
+
+    SECTION("test flat graph") {
+        auto from_datetime = db->ParseDateTime("5/5/2017 0:00");
+        auto to_datetime = db->ParseDateTime("5/9/2017 23:59");
+        for (auto airport_from : {35, 48})
+            for (auto airport_to = db->AirportRange().min; airport_to <= db->AirportRange().max; airport_to += 3) {
+                auto from = FlightNodeKey{airport_from, from_datetime};
+                auto to = FlightNodeKey{airport_to, to_datetime};
+                REQUIRE(NodeGraphPaths<FlightGraphComplete>(db, from, to, true) ==
+                        FlatGraphPaths(planner->Graph(), FlatFlightGraph::Weight::NONE, from, to, true));
+                REQUIRE(NodeGraphPaths<FlightGraphCompleteWithTime>(db, from, to, false) ==
+                        FlatGraphPaths(planner->Graph(), FlatFlightGraph::Weight::TIME, from, to, false));
+                REQUIRE(NodeGraphPaths<FlightGraphCompleteWithPrice>(db, from, to, false) ==
+                        FlatGraphPaths(planner->Graph(), FlatFlightGraph::Weight::PRICE, from, to, false));
+            }
+    }
+
+    SECTION("test dijkstra") {
+        auto from_datetime = db->ParseDateTime("5/5/2017 0:00");
+        auto to_datetime = db->ParseDateTime("5/9/2017 23:59");
+        for (auto weight : {FlatFlightGraph::Weight::TIME, FlatFlightGraph::Weight::PRICE})
+            for (auto airport_from : {28, 35, 48})
+                for (auto airport_to = db->AirportRange().min; airport_to <= db->AirportRange().max; airport_to++) {
+                    auto optimal = OptimalCost(*planner->Graph(), weight, {airport_from, from_datetime}, {airport_to, to_datetime});
+                    auto path = weight == FlatFlightGraph::Weight::TIME
+                                    ? planner->QueryMinimumTimePath(airport_from, airport_to, from_datetime, to_datetime)
+                                    : planner->QueryMinimumCostPath(airport_from, airport_to, from_datetime, to_datetime);
+                    REQUIRE(path.has_value() == optimal.has_value());
+                    if (path)
+                        REQUIRE(PathCost(*path, weight, from_datetime) == *optimal);
+                    for (auto queue : {FlatFlightGraph::Queue::BINARY_HEAP, FlatFlightGraph::Queue::QUATERNARY_HEAP}) {
+                        auto search = FlatFlightGraph(planner->Graph(), weight);
+                        auto from = search.GetNode({airport_from, from_datetime});
+                        auto flat_path = search.ShortestPathTo(from, search.GetNode({airport_to, to_datetime}), queue);
+                        REQUIRE(flat_path.has_value() == optimal.has_value());
+                        if (flat_path)
+                            REQUIRE(FlatPathCost(search, *flat_path, weight) == *optimal);
+                    }
+                    // A* is exact, and its bounds are bounds.
+                    auto bounds = planner->Bounds()->To(airport_to);
+                    auto bound = (weight == FlatFlightGraph::Weight::PRICE ? bounds->price : bounds->time)[airport_from - db->AirportRange().min];
+                    auto search = FlatFlightGraph(planner->Graph(), weight);
+                    auto from = search.GetNode({airport_from, from_datetime});
+                    auto flat_path = search.ShortestPathTo(from, search.GetNode({airport_to, to_datetime}), *bounds);
+                    REQUIRE(flat_path.has_value() == optimal.has_value());
+                    if (flat_path) {
+                        REQUIRE(FlatPathCost(search, *flat_path, weight) == *optimal);
+                        REQUIRE(bound <= *optimal);
+                    }
+                    if (weight != FlatFlightGraph::Weight::PRICE)
+                        continue;
+                    auto journey = BidirectionalSearch(*db).MinimumCost(airport_from, airport_to, from_datetime, to_datetime);
+                    REQUIRE(journey.has_value() == optimal.has_value());
+                    if (journey)
+                        REQUIRE(JourneyPrice(*db, *journey, {airport_from, from_datetime}, {airport_to, to_datetime}) == *optimal);
+                }
+        // From the beginning of time, where the time weight would overflow.
+        auto path = planner->QueryMinimumTimePath(39, 10);
+        REQUIRE(PathToString(path.value()) == PathToString(planner->QueryMinimumTimePath(39, 10, db->ParseDateTime("5/5/2017 0:00")).value()));
+    }
+
+    SECTION("test indexed heap") {
+        auto scratch = SearchScratch::Acquire();
+        scratch->Reset(1000);
+        auto heap = IndexedHeap<4>(*scratch);
+        for (SearchScratch::NodeId node = 0; node < 1000; node++) {
+            scratch->SetPriority(node, (node * 7919) % 1000 + 1000);
+            heap.Push(node);
+        }
+        for (SearchScratch::NodeId node = 0; node < 1000; node += 3) {
+            scratch->SetPriority(node, scratch->GetPriority(node) - 1000);
+            heap.DecreaseKey(node);
+        }
+        auto popped = std::vector<int>();
+        while (!heap.Empty()) {
+            auto node = heap.Pop();
+            REQUIRE(!heap.Contains(node));
+            popped.push_back(scratch->GetPriority(node));
+        }
+        REQUIRE(popped.size() == 1000);
+        REQUIRE(std::is_sorted(popped.begin(), popped.end()));
+        REQUIRE(popped.front() == 0);
+    }
+
+    SECTION("test radix heap") {
+        auto scratch = SearchScratch::Acquire();
+        scratch->Reset(1000);
+        auto heap = RadixHeap(*scratch);
+        auto model = std::multiset<std::pair<int, SearchScratch::NodeId>>();
+        auto last = 0;
+        // Monotone: every priority pushed is at least the last one popped.
+        for (SearchScratch::NodeId node = 0; node < 1000; node++) {
+            scratch->SetPriority(node, last + (node * 7919) % 5000);
+            heap.Push(node);
+            model.insert({scratch->GetPriority(node), node});
+            if (node % 7 == 3) {
+                auto lower = model.begin()->first + int(node * 31 % 200);
+                auto entry = *model.rbegin();
+                if (lower < entry.first) {
+                    model.erase(std::prev(model.end()));
+                    scratch->SetPriority(entry.second, lower);
+                    heap.DecreaseKey(entry.second);
+                    model.insert({lower, entry.second});
+                }
+            }
+            if (node % 3 == 0) {
+                auto popped = heap.Pop();
+                REQUIRE(scratch->GetPriority(popped) == model.begin()->first);
+                model.erase(model.find({scratch->GetPriority(popped), popped}));
+                last = scratch->GetPriority(popped);
+            }
+        }
+        while (!heap.Empty()) {
+            auto popped = heap.Pop();
+            REQUIRE(scratch->GetPriority(popped) == model.begin()->first);
+            model.erase(model.find({scratch->GetPriority(popped), popped}));
+        }
+        REQUIRE(model.empty());
+    }
+
+    SECTION("test time-expanded graph") {
+        auto graph = planner->Graph();
+        auto arrivals = std::set<std::pair<Airport, DateTime>>();
+        for (Key id = 1; size_t(id) <= db->RecordCount(); id++)
+            arrivals.insert({db->AirportToColumn()[id - 1], db->DateTimeToColumn()[id - 1]});
+        REQUIRE(graph->NodeCount() == arrivals.size());
+        REQUIRE(graph->EdgeCount() == db->RecordCount());
+        for (TimeExpandedFlightGraph::NodeId node = 0; node < graph->NodeCount(); node++) {
+            auto key = graph->Key(node);
+            REQUIRE(graph->FindNode(key) == node);
+            auto edges = graph->EdgesOf(node);
+            auto departures = db->QueryRecordIdsByAirportFrom(key.airport, key.no_sooner_than, kDateTimeMax);
+            REQUIRE(edges.end - edges.begin == departures.size());
+            for (auto edge = edges.begin; edge < edges.end; edge++) {
+                auto id = departures[edge - edges.begin];
+                REQUIRE(graph->EdgeRecordColumn()[edge] == id);
+                REQUIRE(graph->Key(graph->EdgeTargetColumn()[edge]) ==
+                        FlightNodeKey{db->AirportToColumn()[id - 1], db->DateTimeToColumn()[id - 1]});
+            }
+        }
+        REQUIRE(graph->FindNode({35, db->ParseDateTime("5/5/2017 0:00")}) == std::nullopt);
+    }
+
+    SECTION("test search scratch") {
+        auto scratch = SearchScratch::Acquire();
+        auto address = scratch.get();
+        scratch->Reset(4);
+        scratch->SetStatus(1, SearchScratch::Status::VISITED);
+        scratch->SetPriority(2, 7);
+        scratch->SetParent(2, 1);
+        REQUIRE(scratch->GetStatus(1) == SearchScratch::Status::VISITED);
+        REQUIRE(scratch->GetPriority(1) == INT_MAX);
+        REQUIRE((scratch->GetPriority(2) == 7 && scratch->GetParent(2) == 1));
+        scratch->Reserve(100);
+        REQUIRE(scratch->GetStatus(1) == SearchScratch::Status::VISITED);
+        scratch->Reset(4);
+        REQUIRE(scratch->Size() >= 100);
+        REQUIRE(scratch->GetStatus(1) == SearchScratch::Status::UNDISCOVERED);
+        REQUIRE((scratch->GetPriority(2) == INT_MAX && scratch->GetParent(2) == SearchScratch::kNoNode));
+        scratch.reset();
+        REQUIRE(SearchScratch::Acquire().get() == address);
+
+        // Dropped on another thread, a scratch still goes back to the pool it came from.
+        scratch = SearchScratch::Acquire();
+        std::thread([scratch = std::move(scratch)]() mutable { scratch.reset(); }).join();
+        REQUIRE(SearchScratch::Acquire().get() == address);
+        // Held by a thread_local that outlives the pool of its thread, it is deleted.
+        std::thread([] {
+            static thread_local auto held = std::shared_ptr<SearchScratch>();
+            held = SearchScratch::Acquire();
+            held->Reset(4);
+        }).join();
+
+        // Queries sharing the graph and the pooled scratches do not see each other's state.
+        auto first = PathToString(*planner->QueryMinimumCostPath(48, 50, db->ParseDateTime("5/5/2017 0:00")));
+        auto airports = planner->EnumerateAirportsBFS(35, db->ParseDateTime("5/5/2017 0:00"))->size();
+        REQUIRE(PathToString(*planner->QueryMinimumCostPath(48, 50, db->ParseDateTime("5/5/2017 0:00"))) == first);
+        REQUIRE(planner->EnumerateAirportsBFS(35, db->ParseDateTime("5/5/2017 0:00"))->size() == airports);
+    }
+}
+
+// Records the order of the search and how deep it went.
+struct DepthVisitor : FlatFlightGraph::Visitor {
+    std::vector<FlatFlightGraph::NodeId> discovered, visited;
+    int depth = 0, max_depth = 0;
+
+    FlatFlightGraph::Control Discover(FlatFlightGraph::NodeId node) {
+        discovered.push_back(node);
+        max_depth = std::max(max_depth, ++depth);
+        return FlatFlightGraph::Control::CONTINUE;
+    }
+    FlatFlightGraph::Control Visit(FlatFlightGraph::NodeId node) {
+        visited.push_back(node);
+        depth--;
+        return FlatFlightGraph::Control::CONTINUE;
+    }
+};
+
+TEST_CASE("test deep dfs", "[flight]") {
+    constexpr int flights = 1000000;
+    auto db = std::make_shared<FlightDatabase>(WriteChainSchedule(flights));
+    auto graph = std::make_shared<const TimeExpandedFlightGraph>(*db);
+    auto start = FlightNodeKey{1, MakeDateTime(2017, 1, 1, 0, 0)};
+    REQUIRE(graph->NodeCount() == flights);
+
+    // The whole chain, one node per level.
+    {
+        auto search = FlatFlightGraph(graph);
+        auto visitor = DepthVisitor();
+        search.DFS(search.GetNode(start), visitor);
+        REQUIRE(visitor.max_depth == flights + 1);
+        REQUIRE(visitor.discovered.size() == flights + 1);
+        auto in_order = true;
+        for (int i = 1; i <= flights; i++)
+            in_order &= search.Key(visitor.discovered[i]).no_sooner_than == start.no_sooner_than + 2 * i - 1;
+        REQUIRE(in_order);
+        REQUIRE(std::equal(visitor.visited.begin(), visitor.visited.end(), visitor.discovered.rbegin()));
+    }
+
+    // A visitor stops the search part way, and the search leaves no frames behind.
+    {
+        struct StoppingVisitor : DepthVisitor {
+            FlatFlightGraph::Control Discover(FlatFlightGraph::NodeId node) {
+                DepthVisitor::Discover(node);
+                return depth == 1000 ? FlatFlightGraph::Control::STOP : FlatFlightGraph::Control::CONTINUE;
+            }
+        };
+        {
+            auto search = FlatFlightGraph(graph);
+            auto visitor = StoppingVisitor();
+            REQUIRE(search.DFS(search.GetNode(start), visitor) == FlatFlightGraph::Control::STOP);
+            REQUIRE((visitor.discovered.size() == 1000 && visitor.visited.empty()));
+        }
+        // The search returned its scratch to the pool, which hands it out again.
+        REQUIRE(SearchScratch::Acquire()->Stack().empty());
+    }
+
+    // A depth limit, in the same order as the node graph.
+    {
+        auto search = FlatFlightGraph(graph);
+        auto visitor = DepthVisitor();
+        search.DFS(search.GetNode(start), visitor, 64);
+        REQUIRE(visitor.max_depth == 65);
+
+        auto node_graph = std::make_shared<FlightGraphComplete>(db);
+        auto keys = std::vector<FlightNodeKey>();
+        node_graph->OnNodeDiscovered.AddListener([&](auto node) { keys.push_back(node->Key()); });
+        node_graph->GetNode(start)->DFS(64);
+        REQUIRE(keys.size() == visitor.discovered.size());
+        for (size_t i = 0; i < keys.size(); i++)
+            REQUIRE(keys[i] == search.Key(visitor.discovered[i]));
+    }
+
+    // The node graph down a chain far deeper than a recursive DFS could go
+    // on the call stack.
+    {
+        constexpr int node_flights = 200000;
+        auto node_graph = std::make_shared<FlightGraphComplete>(std::make_shared<FlightDatabase>(WriteChainSchedule(node_flights)));
+        auto discovered = size_t(0), visited = size_t(0);
+        auto last = FlightNodeKey{0, 0};
+        node_graph->OnNodeDiscovered.AddListener([&](auto) { discovered++; });
+        node_graph->OnNodeVisited.AddListener([&](auto node) {
+            if (visited++ == 0)
+                last = node->Key();
+        });
+        node_graph->GetNode(start)->DFS();
+        REQUIRE(discovered == node_flights + 1);
+        REQUIRE(visited == node_flights + 1);
+        REQUIRE(last.no_sooner_than == start.no_sooner_than + 2 * node_flights - 1);
+    }
+}
+
+TEST_CASE("test connection scan", "[flight]") {
+    auto db = std::make_shared<FlightDatabase>(WriteSyntheticSchedule(20000, 40));
+    auto planner = Planner(db);
+    auto connections = planner.Connections()->Connections();
+    REQUIRE(connections.size() == db->RecordCount());
+    REQUIRE(std::is_sorted(connections.begin(), connections.end(),
+                           [](auto& a, auto& b) { return a.departure < b.departure; }));
+
+    // The earliest arrival of the scan is the optimum of Dijkstra on the graph.
+    auto airports = db->AirportRange();
+    for (auto [day_from, day_to] : {std::pair{5, 6}, std::pair{10, 24}, std::pair{20, 20}})
+        for (auto airport_from = airports.min; airport_from <= airports.max; airport_from += 7)
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to++) {
+                auto datetime_from = MakeDateTime(2017, 5, day_from, 6, 0);
+                auto datetime_to = MakeDateTime(2017, 5, day_to, 18, 0);
+                auto journey = planner.Connections()->EarliestArrival(airport_from, airport_to, datetime_from, datetime_to);
+                auto search = FlatFlightGraph(planner.Graph(), FlatFlightGraph::Weight::TIME);
+                auto from = search.GetNode({airport_from, datetime_from});
+                auto path = search.ShortestPathTo(from, search.GetNode({airport_to, datetime_to}));
+                REQUIRE(journey.has_value() == path.has_value());
+                if (!journey)
+                    continue;
+                auto arrival = (*journey)->empty() ? datetime_from : db->QueryRecordById((*journey)->back()).datetime_to;
+                REQUIRE(arrival == search.Key((*path)->back()).no_sooner_than);
+                auto at = FlightNodeKey{airport_from, datetime_from};
+                for (auto id : **journey) {
+                    auto record = db->QueryRecordById(id);
+                    REQUIRE((record.airport_from == at.airport && record.datetime_from >= at.no_sooner_than));
+                    at = {record.airport_to, record.datetime_to};
+                }
+                REQUIRE(at.airport == airport_to);
+            }
+
+    // The profile answers the earliest arrival from every time in its window.
+    auto datetime_from = MakeDateTime(2017, 5, 8, 0, 0), datetime_to = MakeDateTime(2017, 5, 12, 0, 0);
+    for (auto airport_from = airports.min; airport_from <= airports.max; airport_from += 5)
+        for (auto airport_to = airports.min; airport_to <= airports.max; airport_to += 3) {
+            auto profile = planner.QueryArrivalProfile(airport_from, airport_to, datetime_from, datetime_to);
+            for (size_t i = 1; i < profile->size(); i++)
+                REQUIRE(((*profile)[i - 1].departure < (*profile)[i].departure && (*profile)[i - 1].arrival < (*profile)[i].arrival));
+            for (auto datetime = datetime_from; datetime <= datetime_to; datetime += 97) {
+                auto journey = planner.Connections()->EarliestArrival(airport_from, airport_to, datetime, datetime_to);
+                auto entry = std::find_if(profile->begin(), profile->end(), [&](auto& entry) { return entry.departure >= datetime; });
+                if (airport_from == airport_to)
+                    continue;
+                REQUIRE(journey.has_value() == (entry != profile->end()));
+                if (journey)
+                    REQUIRE(db->QueryRecordById((*journey)->back()).datetime_to == entry->arrival);
+            }
+        }
+}
+
+TEST_CASE("test bidirectional search", "[flight]") {
+    auto db = std::make_shared<FlightDatabase>(WriteSyntheticSchedule(5000, 40));
+    auto graph = TimeExpandedFlightGraph(*db);
+    auto search = BidirectionalSearch(*db);
+
+    // Windows from a day to the whole month, where the two sides meet on
+    // journeys that either side alone would have to settle most flights for.
+    auto airports = db->AirportRange();
+    for (auto [day_from, day_to] : {std::pair{5, 6}, std::pair{10, 24}, std::pair{1, 31}, std::pair{20, 20}})
+        for (auto airport_from = airports.min; airport_from <= airports.max; airport_from += 7)
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to += 2) {
+                auto from = FlightNodeKey{airport_from, MakeDateTime(2017, 5, day_from, 6, 0)};
+                auto to = FlightNodeKey{airport_to, MakeDateTime(2017, 5, day_to, 18, 0)};
+                auto optimal = OptimalCost(graph, FlatFlightGraph::Weight::PRICE, from, to);
+                auto journey = search.MinimumCost(airport_from, airport_to, from.no_sooner_than, to.no_sooner_than);
+                REQUIRE(journey.has_value() == optimal.has_value());
+                if (journey)
+                    REQUIRE(JourneyPrice(*db, *journey, from, to) == *optimal);
+            }
+    REQUIRE(!search.MinimumCost(airports.min, airports.max, MakeDateTime(2017, 5, 9, 0, 0), MakeDateTime(2017, 5, 8, 0, 0)));
+    REQUIRE_THROWS(search.MinimumCost(airports.min, airports.max + 1, kDateTimeMin, kDateTimeMax));
+}
+
+TEST_CASE("test pareto paths", "[flight]") {
+    auto db = std::make_shared<FlightDatabase>(WriteSyntheticSchedule(5000, 40));
+    auto planner = Planner(db);
+    auto airports = db->AirportRange();
+    for (auto [day_from, day_to] : {std::pair{5, 6}, std::pair{10, 24}, std::pair{1, 31}})
+        for (auto airport_from = airports.min; airport_from <= airports.max; airport_from += 7)
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to += 2)
+                CheckParetoPaths(planner, *db, {airport_from, MakeDateTime(2017, 5, day_from, 6, 0)}, {airport_to, MakeDateTime(2017, 5, day_to, 18, 0)});
+}
+
+TEST_CASE("test raptor", "[flight]") {
+    auto db = std::make_shared<FlightDatabase>(WriteSyntheticSchedule(5000, 40));
+    auto planner = Planner(db);
+    auto continued = ContinuedFlights(*db);
+    // Every trip is on one route, whose trips keep their order at every stop.
+    auto trips = planner.Trips();
+    REQUIRE(trips->TripCount() == size_t(std::count(continued.begin(), continued.end(), -1)));
+    for (auto& route : trips->Routes())
+        REQUIRE(route.trip_count > 0);
+
+    auto airports = db->AirportRange();
+    for (auto [day_from, day_to] : {std::pair{5, 6}, std::pair{10, 24}, std::pair{1, 31}})
+        for (auto airport_from = airports.min; airport_from <= airports.max; airport_from += 7)
+            for (auto airport_to = airports.min; airport_to <= airports.max; airport_to += 2)
+                CheckRounds(planner, *db, continued, {airport_from, MakeDateTime(2017, 5, day_from, 6, 0)}, {airport_to, MakeDateTime(2017, 5, day_to, 18, 0)});
+    // Round k stops at k rides.
+    auto datetime_from = MakeDateTime(2017, 5, 5, 6, 0), datetime_to = MakeDateTime(2017, 5, 24, 18, 0);
+    for (auto airport_to = airports.min + 1; airport_to <= airports.max; airport_to++) {
+        auto all = trips->Journeys(airports.min, airport_to, datetime_from, datetime_to);
+        auto one = trips->Journeys(airports.min, airport_to, datetime_from, datetime_to, 1);
+        REQUIRE(one->size() == size_t(!all->empty() && Rides(continued, *all->front()) == 1));
+        REQUIRE(trips->Journeys(airports.min, airport_to, datetime_from, datetime_to, 0)->empty());
+    }
+    REQUIRE(trips->Journeys(airports.min, airports.min, datetime_from, datetime_to, 0)->front()->empty());
+    REQUIRE_THROWS(trips->Journeys(airports.min, airports.max, datetime_from, datetime_to, -1));
 }
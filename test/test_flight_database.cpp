@@ -0,0 +1,336 @@
+#include <catch2/catch_test_macros.hpp>
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <tuple>
+#include <vector>
+#include "../project/include/compact_flight_graph_node_container.hpp"
+#include "../project/include/csv_scanner.hpp"
+#include "../project/include/flight_database.hpp"
+#include "../project/include/flight_snapshot.hpp"
+#include "synthetic_schedule.hpp"
+
+static bool SameRecord(const FlightDatabase::Record& a, const FlightDatabase::Record& b) {
+    return a.id == b.id && a.airport_from == b.airport_from && a.airport_to == b.airport_to &&
+           a.datetime_from == b.datetime_from && a.datetime_to == b.datetime_to && a.price == b.price &&
+           a.flight_number == b.flight_number;
+}
+
+// Checks the time-sliced bucket queries against filtering the whole bucket.
+static void RequireTimeSlices(const FlightDatabase& db) {
+    auto windows = {std::pair(kDateTimeMin, kDateTimeMax),
+                    std::pair(MakeDateTime(2017, 5, 6, 0, 0), MakeDateTime(2017, 5, 7, 0, 0)),
+                    std::pair(MakeDateTime(2017, 5, 5, 12, 20), MakeDateTime(2017, 5, 5, 12, 20)),
+                    std::pair(MakeDateTime(2017, 5, 8, 0, 0), MakeDateTime(2017, 5, 6, 0, 0))};
+    for (auto airport = db.AirportRange().min; airport <= db.AirportRange().max; airport++)
+        for (auto [not_before, not_after] : windows) {
+            auto check = [&](std::span<const Key> all, std::span<const Key> slice, std::span<const DateTime> column) {
+                auto expected = std::vector<Key>();
+                for (auto id : all)
+                    if (column[id - 1] >= not_before && column[id - 1] <= not_after)
+                        expected.push_back(id);
+                REQUIRE(std::equal(expected.begin(), expected.end(), slice.begin(), slice.end()));
+            };
+            check(db.QueryRecordIdsByAirportFrom(airport), db.QueryRecordIdsByAirportFrom(airport, not_before, not_after),
+                  db.DateTimeFromColumn());
+            check(db.QueryRecordIdsByAirportTo(airport), db.QueryRecordIdsByAirportTo(airport, not_before, not_after),
+                  db.DateTimeToColumn());
+        }
+}
+
+// Checks the route index against filtering the departure bucket of every origin.
+static void RequireRoutes(const FlightDatabase& db) {
+    auto range = db.AirportRange();
+    auto window = std::pair(MakeDateTime(2017, 5, 6, 0, 0), MakeDateTime(2017, 5, 7, 0, 0));
+    size_t total = 0;
+    for (auto from = range.min; from <= range.max; from++)
+        for (auto to = range.min; to <= range.max + 1; to++) {
+            auto by_departure = std::vector<Key>(), in_window = std::vector<Key>();
+            for (auto id : db.QueryRecordIdsByAirportFrom(from))
+                if (db.AirportToColumn()[id - 1] == to) {
+                    by_departure.push_back(id);
+                    auto departure = db.DateTimeFromColumn()[id - 1];
+                    if (departure >= window.first && departure <= window.second)
+                        in_window.push_back(id);
+                }
+            auto route = db.QueryRecordIdsByRoute(from, to);
+            REQUIRE(std::equal(by_departure.begin(), by_departure.end(), route.begin(), route.end()));
+            route = db.QueryRecordIdsByRoute(from, to, window.first, window.second);
+            REQUIRE(std::equal(in_window.begin(), in_window.end(), route.begin(), route.end()));
+            auto by_arrival = db.QueryRecordIdsByRouteArrival(from, to, kDateTimeMin, kDateTimeMax);
+            REQUIRE(by_arrival.size() == by_departure.size());
+            REQUIRE(std::is_permutation(by_arrival.begin(), by_arrival.end(), by_departure.begin()));
+            for (size_t i = 1; i < by_arrival.size(); i++)
+                REQUIRE(db.DateTimeToColumn()[by_arrival[i - 1] - 1] <= db.DateTimeToColumn()[by_arrival[i] - 1]);
+            total += by_departure.size();
+        }
+    REQUIRE(total == db.RecordCount());
+    REQUIRE_THROWS(db.QueryRecordIdsByRoute(range.max + 1, range.min));
+}
+
+static void RequireSameRecords(const FlightDatabase& a, const FlightDatabase& b, int count) {
+    for (int id = 1; id <= count; id++)
+        REQUIRE(SameRecord(a.QueryRecordById(id), b.QueryRecordById(id)));
+}
+
+// CTest runs every test case in a process of its own, so here the loader
+// threads are the first to use the scanner and pick its kind together.
+TEST_CASE("test parallel first load", "[flight]") {
+    auto filename = WriteSyntheticSchedule(5000);
+    auto parallel = FlightDatabase(filename, FlightDatabase::LoadMode::MAPPED, 8);
+    REQUIRE(CsvScanner::Active() == CsvScanner::Detect());
+    auto stream = FlightDatabase(filename, FlightDatabase::LoadMode::STREAM);
+    RequireSameRecords(stream, parallel, 5000);
+}
+
+TEST_CASE("test flight database", "[flight]") {
+    SECTION("test mapped loader") {
+        {
+            auto stream = FlightDatabase("../project/data/flight-data.csv", FlightDatabase::LoadMode::STREAM);
+            auto mapped = FlightDatabase("../project/data/flight-data.csv", FlightDatabase::LoadMode::MAPPED);
+            RequireSameRecords(stream, mapped, 2346);
+        }
+        {
+            auto filename = WriteSyntheticSchedule(5000);
+            auto stream = FlightDatabase(filename, FlightDatabase::LoadMode::STREAM);
+            auto mapped = FlightDatabase(filename, FlightDatabase::LoadMode::MAPPED);
+            RequireSameRecords(stream, mapped, 5000);
+        }
+    }
+
+    SECTION("test parallel loader") {
+        {
+            auto stream = FlightDatabase("../project/data/flight-data.csv", FlightDatabase::LoadMode::STREAM);
+            auto parallel = FlightDatabase("../project/data/flight-data.csv", FlightDatabase::LoadMode::MAPPED, 4);
+            RequireSameRecords(stream, parallel, 2346);
+        }
+        {
+            auto filename = WriteSyntheticSchedule(5000);
+            auto stream = FlightDatabase(filename, FlightDatabase::LoadMode::STREAM);
+            for (int threads : {2, 3, 7, 64}) {
+                auto parallel = FlightDatabase(filename, FlightDatabase::LoadMode::MAPPED, threads);
+                RequireSameRecords(stream, parallel, 5000);
+            }
+        }
+        {
+            // The last row repeats Flight ID 1, which the first chunk holds.
+            auto lines = std::vector<std::string>();
+            auto input = std::ifstream("../project/data/flight-data.csv");
+            for (auto line = std::string(); std::getline(input, line);)
+                lines.push_back(line);
+            lines.back() = "1" + lines.back().substr(lines.back().find(','));
+            auto filename = (std::filesystem::temp_directory_path() / "flight-data-duplicate.csv").string();
+            {
+                auto output = std::ofstream(filename);
+                for (auto& line : lines)
+                    output << line << '\n';
+            }
+            for (int threads : {2, 4})
+                REQUIRE_THROWS(FlightDatabase(filename, FlightDatabase::LoadMode::MAPPED, threads));
+            std::filesystem::remove(filename);
+        }
+    }
+
+    SECTION("test csv scanner") {
+        auto line = std::string("1,5/5/2017,Dome,346,48,50,5/5/2017 12:20,5/5/2017 15:10,30,1,666,") +
+                    std::string(100, 'x') + ",y\nnext";
+        for (auto kind : {CsvScanner::Kind::SCALAR, CsvScanner::Kind::SSE2, CsvScanner::Kind::AVX2}) {
+            if (!CsvScanner::Supported(kind))
+                continue;
+            CsvScanner::Select(kind);
+            const char* delimiters[16];
+            auto begin = line.data();
+            auto end = line.data() + line.size();
+            REQUIRE(CsvScanner::SplitLine(begin, end, delimiters, 16) == 13);
+            REQUIRE(delimiters[0] - begin == 1);
+            REQUIRE(delimiters[10] - begin == 64);
+            REQUIRE(*delimiters[12] == '\n');
+            REQUIRE(CsvScanner::SplitLine(begin, end, delimiters, 4) == 4);
+            REQUIRE(*delimiters[3] == '\n');
+            REQUIRE(CsvScanner::SplitLine(delimiters[3] + 1, end, delimiters, 4) == 1);
+            REQUIRE(delimiters[0] == end);
+        }
+        CsvScanner::Select(CsvScanner::Detect());
+    }
+
+    SECTION("test in-place record parsing") {
+        auto text = std::string(
+            "7,12/31/2017,Intl,1,3,4,12/31/2017 23:59,1/1/2018 1:05,30,1,1234\r\n"
+            "8,5/5/2017,Dome,2,4,3,05/05/2017 09:07,5/5/2017 10:00,30,1,99\n"
+            "\n"
+            "9,5/5/2017,Dome,2,4,3,5/5/2017 9:07,5/5/2017 10:00,30,1,99\n");
+        auto records = Vector<FlightDatabase::Record>();
+        REQUIRE(!FlightDatabase::ParseRecords(text, records));
+        REQUIRE(records.size() == 2);
+        REQUIRE(records[0].id == 7);
+        REQUIRE(records[0].datetime_from == MakeDateTime(2017, 12, 31, 23, 59));
+        REQUIRE(records[0].datetime_to == MakeDateTime(2018, 1, 1, 1, 5));
+        REQUIRE(records[0].datetime_to - records[0].datetime_from == 66);
+        REQUIRE(records[0].price == 1234);
+        REQUIRE(records[1].datetime_from == MakeDateTime(2017, 5, 5, 9, 7));
+        auto last_line = std::string_view(text).substr(text.rfind("\n9,") + 1);
+        last_line.remove_suffix(1);
+        REQUIRE(FlightDatabase::ParseRecords(last_line, records));
+        REQUIRE((records.size() == 3 && records[2].id == 9 && records[2].price == 99));
+        REQUIRE_THROWS(FlightDatabase::ParseRecords("1,2,3\n", records));
+        REQUIRE_THROWS(FlightDatabase::ParseRecords("1,5/5/2017,Dome,2,4,3,5/5/2017 9:07,5/5/2017,30,1,99\n", records));
+    }
+
+    SECTION("test snapshot") {
+        auto csv = FlightDatabase("../project/data/flight-data.csv");
+        auto filename = (std::filesystem::temp_directory_path() / "flight-data-test.fdb").string();
+        csv.SaveSnapshot(filename);
+        FlightDatabase::VerifySnapshot(filename);
+        {
+            auto snapshot = FlightDatabase(filename, FlightDatabase::LoadMode::SNAPSHOT);
+            REQUIRE(snapshot.RecordCount() == 2346);
+            REQUIRE(snapshot.AirportRange().min == csv.AirportRange().min);
+            REQUIRE(snapshot.AirportRange().max == csv.AirportRange().max);
+            RequireSameRecords(csv, snapshot, 2346);
+            for (auto airport = csv.AirportRange().min; airport <= csv.AirportRange().max; airport++) {
+                auto from = csv.QueryRecordIdsByAirportFrom(airport);
+                auto to = csv.QueryRecordIdsByAirportTo(airport);
+                REQUIRE(std::equal(from.begin(), from.end(), snapshot.QueryRecordIdsByAirportFrom(airport).begin(),
+                                   snapshot.QueryRecordIdsByAirportFrom(airport).end()));
+                REQUIRE(std::equal(to.begin(), to.end(), snapshot.QueryRecordIdsByAirportTo(airport).begin(),
+                                   snapshot.QueryRecordIdsByAirportTo(airport).end()));
+            }
+            REQUIRE_THROWS(snapshot.QueryRecordIdsByAirportFrom(csv.AirportRange().max + 1));
+            RequireTimeSlices(snapshot);
+            RequireRoutes(snapshot);
+        }
+        // Loading does not verify the checksum, so each of these reaches the
+        // section checks: an id past the table, an airport out of range and
+        // offsets that run backwards.
+        auto corruptions = {std::tuple(SnapshotSectionId::FROM_IDS, 7, int64_t(2347)),
+                            std::tuple(SnapshotSectionId::ROUTE_IDS_BY_ARRIVAL, 0, int64_t(0)),
+                            std::tuple(SnapshotSectionId::AIRPORT_TO, 3, int64_t(csv.AirportRange().max + 1)),
+                            std::tuple(SnapshotSectionId::ROUTE_DESTINATIONS, 1, int64_t(0)),
+                            std::tuple(SnapshotSectionId::ROUTE_OFFSETS, 2, int64_t(2346)),
+                            std::tuple(SnapshotSectionId::ROUTE_ORIGINS, 1, int64_t(100000))};
+        for (auto [id, index, value] : corruptions) {
+            auto header = SnapshotHeader();
+            auto file = std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
+            file.read(reinterpret_cast<char*>(&header), sizeof(header));
+            for (uint32_t i = 0; i < header.section_count; i++) {
+                auto section = SnapshotSection();
+                file.read(reinterpret_cast<char*>(&section), sizeof(section));
+                if (section.id != id)
+                    continue;
+                auto saved = std::vector<char>(section.element_size);
+                file.seekg(section.offset + index * section.element_size);
+                file.read(saved.data(), saved.size());
+                file.seekp(section.offset + index * section.element_size);
+                file.write(reinterpret_cast<const char*>(&value), section.element_size);
+                file.flush();
+                REQUIRE_THROWS(FlightDatabase(filename, FlightDatabase::LoadMode::SNAPSHOT));
+                file.seekp(section.offset + index * section.element_size);
+                file.write(saved.data(), saved.size());
+                break;
+            }
+        }
+        FlightDatabase::VerifySnapshot(filename);
+        {
+            auto file = std::fstream(filename, std::ios::in | std::ios::out | std::ios::binary);
+            file.seekp(std::filesystem::file_size(filename) / 2);
+            file.put('\x7f');
+        }
+        REQUIRE_THROWS(FlightDatabase::VerifySnapshot(filename));
+        REQUIRE_THROWS(FlightDatabase("../project/data/flight-data.csv", FlightDatabase::LoadMode::SNAPSHOT));
+        std::filesystem::remove(filename);
+    }
+
+    SECTION("test datetime conversion") {
+        REQUIRE(MakeDateTime(1970, 1, 1, 0, 0) == 0);
+        REQUIRE(MakeDateTime(2017, 5, 5, 12, 20) == 24899780);
+        REQUIRE(MakeDateTime(2017, 3, 1, 0, 0) - MakeDateTime(2017, 2, 28, 23, 0) == 60);
+        REQUIRE(MakeDateTime(2016, 3, 1, 0, 0) - MakeDateTime(2016, 2, 28, 23, 0) == 24 * 60 + 60);
+        REQUIRE(MakeDateTime(2017, 10, 0, 23, 59) == MakeDateTime(2017, 9, 30, 23, 59));
+        for (auto datetime : {MakeDateTime(2017, 5, 5, 12, 20), MakeDateTime(2000, 2, 29, 0, 1), MakeDateTime(1969, 12, 31, 23, 59)}) {
+            auto civil = CivilFromDateTime(datetime);
+            REQUIRE(MakeDateTime(civil.year, civil.month, civil.day, civil.hour, civil.minute) == datetime);
+        }
+        auto civil = CivilFromDateTime(MakeDateTime(2017, 12, 31, 23, 59));
+        REQUIRE((civil.year == 2017 && civil.month == 12 && civil.day == 31 && civil.hour == 23 && civil.minute == 59));
+        REQUIRE(CivilFromDateTime(MakeDateTime(6000, 1, 1, 0, 0)).year == 6000);
+        REQUIRE_THROWS(MakeDateTime(9999, 1, 1, 0, 0));
+        REQUIRE_THROWS(MakeDateTime(-3000, 1, 1, 0, 0));
+        REQUIRE_THROWS(MakeDateTime(2017, 5, 2000000000, 0, 0));
+        auto db = FlightDatabase("../project/data/flight-data.csv");
+        REQUIRE_THROWS(db.ParseDateTime("5/5/9999 0:00"));
+        auto records = Vector<FlightDatabase::Record>();
+        REQUIRE_THROWS(FlightDatabase::ParseRecords("1,5/5/2017,Dome,2,4,3,5/5/9999 9:07,5/5/9999 10:00,30,1,99\n", records));
+    }
+
+    SECTION("test columns") {
+        auto db = FlightDatabase("../project/data/flight-data.csv");
+        REQUIRE(FlightDatabase::kBytesPerRecord == 20);
+        REQUIRE(db.PriceColumn().size() == db.RecordCount());
+        for (Key id = 1; size_t(id) <= db.RecordCount(); id++) {
+            auto record = db.QueryRecordById(id);
+            REQUIRE(record.id == id);
+            REQUIRE(record.airport_from == db.AirportFromColumn()[id - 1]);
+            REQUIRE(record.airport_to == db.AirportToColumn()[id - 1]);
+            REQUIRE(record.datetime_from == db.DateTimeFromColumn()[id - 1]);
+            REQUIRE(record.datetime_to == db.DateTimeToColumn()[id - 1]);
+            REQUIRE(record.price == db.PriceColumn()[id - 1]);
+            REQUIRE(record.flight_number == db.FlightNumberColumn()[id - 1]);
+        }
+        auto record = db.QueryRecordById(1);
+        REQUIRE((record.airport_from == 48 && record.airport_to == 50 && record.price == 666 && record.flight_number == 346));
+    }
+
+    SECTION("test time slices") {
+        RequireTimeSlices(FlightDatabase("../project/data/flight-data.csv"));
+        RequireTimeSlices(FlightDatabase(WriteSyntheticSchedule(5000)));
+    }
+
+    SECTION("test compact bucket index") {
+        auto db = FlightDatabase("../project/data/flight-data.csv");
+        auto range = db.AirportRange();
+        size_t total = 0;
+        for (auto airport = range.min; airport <= range.max; airport++) {
+            auto bucket = db.QueryRecordIdsByAirportFrom(airport);
+            for (size_t i = 0; i < bucket.size(); i++) {
+                REQUIRE(db.AirportFromColumn()[bucket[i] - 1] == airport);
+                if (i > 0)
+                    REQUIRE(db.DateTimeFromColumn()[bucket[i - 1] - 1] <= db.DateTimeFromColumn()[bucket[i] - 1]);
+            }
+            total += bucket.size();
+        }
+        REQUIRE(total == db.RecordCount());
+
+        Key elements[] = {5, 3, 4, 1, 2};
+        DateTime datetimes[] = {10, 30, 30, 40, 50};
+        auto index = CompactFlightGraphNodeContainer<Key>(
+            {1, 3}, elements, [](Key id) { return id % 2 == 0 ? 2 : 1; },
+            [&](Key id) { return datetimes[id - 1]; },
+            [&](Key a, Key b) { return std::pair(datetimes[a - 1], a) < std::pair(datetimes[b - 1], b); });
+        auto odd = index.Get(1);
+        REQUIRE(std::vector<Key>(odd.begin(), odd.end()) == std::vector<Key>{1, 3, 5});
+        REQUIRE(index.Get(2).size() == 2);
+        REQUIRE(index.Get(3).empty());
+        REQUIRE(index.Offsets().size() == 4);
+        REQUIRE(index.Get(1, 30) == std::optional<Key>(3));
+        REQUIRE(index.Get(1, 31) == std::nullopt);
+        REQUIRE(index.Get(1, 20, 50).size() == 2);
+        REQUIRE_THROWS(index.Get(4));
+        datetimes[3] = 30;
+        auto duplicated = CompactFlightGraphNodeContainer<Key>(
+            {1, 2}, elements, [](Key id) { return id % 2 == 0 ? 2 : 1; },
+            [&](Key id) { return datetimes[id - 1]; },
+            [&](Key a, Key b) { return std::pair(datetimes[a - 1], a) < std::pair(datetimes[b - 1], b); });
+        REQUIRE_THROWS(duplicated.Get(2, 30));
+        uint32_t bad_offsets[] = {0, 3, 2};
+        REQUIRE_THROWS(CompactFlightGraphNodeContainer<Key>({1, 2}, bad_offsets, index.Elements(), index.DateTimes()));
+    }
+
+    SECTION("test route index") {
+        auto db = FlightDatabase("../project/data/flight-data.csv");
+        RequireRoutes(db);
+        RequireRoutes(FlightDatabase(WriteSyntheticSchedule(5000)));
+        auto record = db.QueryRecordById(1);
+        REQUIRE(db.QueryRecordByAirportsAndArrivalTime(record.airport_from, record.airport_to, record.datetime_to).id == 1);
+        REQUIRE_THROWS(db.QueryRecordByAirportsAndArrivalTime(record.airport_from, record.airport_to, record.datetime_to + 1));
+    }
+}